@@ -1,65 +1,206 @@
 #include "common.h"
 #include "graph.h"
 #include "scheduler.h"
+#include "scenario.h"
 
 int main(int argc, char *argv[]) {
     cout << "Begin" << std::endl;
 
-	if(argc < 5){
-		std::cout << "please input args: carPath, roadPath, crossPath, answerPath" << std::endl;
-		exit(1);
+	/*
+	 * 以--开头的为可选参数：
+	 * 		--lookahead=N			开启N个时间片的后台死锁预测
+	 * 		--scenario=PATH			从预编译场景文件载入，此时只需answerPath
+	 * 		--save-scenario=PATH	将输入文件转换为预编译场景文件后退出
+	 * 		--stream-answer			车辆到达终点且不会再回滚时即写出答案
+	 * 		--telemetry=PATH		记录每个时间片的统计，结束时导出(.bin为二进制，否则为CSV)
+	 * 		--trace-status			每个时间片将车道状态追加到road_log.txt
+	 * 		--trace-log				死锁时输出所有等待车辆
+	 * 		--judge=PATH			按答案文件复现调度并评分，此时不需要answerPath
+	 * 		--perf-counters			分阶段统计硬件计数器，需以PROFILE编译
+	 * 		--digest=PATH			每个时间片的状态摘要写入PATH
+	 * 		--digest-ref=PATH		与PATH中的摘要逐个比较，首次不一致时退出
+	 * 		--memory-report			存档时统计各数据结构的内存，结束时输出
+	 * 		--refresh-threshold=X	道路负载累计变化超过X才重算路由表，默认0即每个时间片重算
+	 * 		--refresh-max-stale=N	路由表最多连续沿用N个时间片
+	 * 		--capacity-departure	按区域容量放车，替代goCarSize
+	 * 		--global-load=X			全网在途车辆不超过X倍总容量
+	 * 		--region-size=N			每个区域包含N * N个路口
+	 * 		--forecast=H			预测H个时间片内的道路车辆数，按车辆预计驶入时刻计算权重
+	 * 		--preset-cache=PATH		缓存预置车辆排序，输入不变时跳过预演
+	 * 		--plan-routes=K			非优先车辆出发时从K条候选路径中选择完整路径
+	 * 		--yen-paths				候选路径改为预先并行计算的K条无环最短路，拥堵时改走最空闲的候选
+	 * 		--path-threads=N		计算候选路径的线程数，默认按硬件线程数
+	 * 		--dead-cycle			建立等待图，发现死锁环即回滚，只惩罚环上道路
+	 */
+	vector<string> args;
+	int lookahead = 0;
+	bool streamAnswer = false;
+	bool traceStatus = false, traceLog = false;
+	bool perfCounters = false;
+	bool memoryReport = false;
+	double refreshThreshold = 0;
+	int refreshMaxStale = 0;
+	bool capacityDeparture = false;
+	double globalLoad = 0;
+	int regionSize = 0;
+	int forecastHorizon = 0;
+	string presetCachePath;
+	int planRoutes = 0;
+	bool yenPaths = false;
+	int pathThreads = 0;
+	bool deadCycle = false;
+	string scenarioPath, saveScenarioPath, telemetryPath, judgePath;
+	string digestPath, digestRefPath;
+	for (int i = 1; i < argc; ++i) {
+		if (strncmp(argv[i], "--lookahead=", 12) == 0)
+			lookahead = atoi(argv[i] + 12);
+		else if (strncmp(argv[i], "--scenario=", 11) == 0)
+			scenarioPath = argv[i] + 11;
+		else if (strncmp(argv[i], "--save-scenario=", 16) == 0)
+			saveScenarioPath = argv[i] + 16;
+		else if (strcmp(argv[i], "--stream-answer") == 0)
+			streamAnswer = true;
+		else if (strncmp(argv[i], "--telemetry=", 12) == 0)
+			telemetryPath = argv[i] + 12;
+		else if (strcmp(argv[i], "--trace-status") == 0)
+			traceStatus = true;
+		else if (strcmp(argv[i], "--trace-log") == 0)
+			traceLog = true;
+		else if (strncmp(argv[i], "--judge=", 8) == 0)
+			judgePath = argv[i] + 8;
+		else if (strcmp(argv[i], "--perf-counters") == 0)
+			perfCounters = true;
+		else if (strncmp(argv[i], "--digest=", 9) == 0)
+			digestPath = argv[i] + 9;
+		else if (strncmp(argv[i], "--digest-ref=", 13) == 0)
+			digestRefPath = argv[i] + 13;
+		else if (strcmp(argv[i], "--memory-report") == 0)
+			memoryReport = true;
+		else if (strncmp(argv[i], "--refresh-threshold=", 20) == 0)
+			refreshThreshold = atof(argv[i] + 20);
+		else if (strncmp(argv[i], "--refresh-max-stale=", 20) == 0)
+			refreshMaxStale = atoi(argv[i] + 20);
+		else if (strcmp(argv[i], "--capacity-departure") == 0)
+			capacityDeparture = true;
+		else if (strncmp(argv[i], "--global-load=", 14) == 0)
+			globalLoad = atof(argv[i] + 14);
+		else if (strncmp(argv[i], "--region-size=", 14) == 0)
+			regionSize = atoi(argv[i] + 14);
+		else if (strncmp(argv[i], "--forecast=", 11) == 0)
+			forecastHorizon = atoi(argv[i] + 11);
+		else if (strncmp(argv[i], "--preset-cache=", 15) == 0)
+			presetCachePath = argv[i] + 15;
+		else if (strncmp(argv[i], "--plan-routes=", 14) == 0)
+			planRoutes = atoi(argv[i] + 14);
+		else if (strcmp(argv[i], "--yen-paths") == 0)
+			yenPaths = true;
+		else if (strncmp(argv[i], "--path-threads=", 15) == 0)
+			pathThreads = atoi(argv[i] + 15);
+		else if (strcmp(argv[i], "--dead-cycle") == 0)
+			deadCycle = true;
+		else
+			args.emplace_back(argv[i]);
 	}
 
-	string carPath(argv[1]);
-	string roadPath(argv[2]);
-	string crossPath(argv[3]);
-	string presetAnswerPath(argv[4]);
-	string answerPath(argv[5]);
+	Scheduler* scheduler = nullptr;
+	string answerPath;
+	bool needAnswer = saveScenarioPath.empty() and judgePath.empty();
+	if (not scenarioPath.empty()) {
+		if (needAnswer and args.size() < 1) {
+			std::cout << "please input args: --scenario=scenarioPath answerPath" << std::endl;
+			exit(1);
+		}
+		cout << "scenarioPath is " << scenarioPath << std::endl;
+		scheduler = new Scheduler(scenarioPath);
+		if (needAnswer) {
+			answerPath = args[0];
+			cout << "answerPath is " << answerPath << std::endl;
+		}
+	} else {
+		if (args.size() < 4 or (args.size() < 5 and needAnswer)) {
+			std::cout << "please input args: carPath, roadPath, crossPath, presetAnswerPath, answerPath" << std::endl;
+			exit(1);
+		}
 
-	cout << "carPath is " << carPath << std::endl;
-	cout << "roadPath is " << roadPath << std::endl;
-	cout << "crossPath is " << crossPath << std::endl;
-	cout << "presetAnswerPath is " << presetAnswerPath << endl;
-	cout << "answerPath is " << answerPath << std::endl;
+		string carPath(args[0]);
+		string roadPath(args[1]);
+		string crossPath(args[2]);
+		string presetAnswerPath(args[3]);
 
-    // TODO:read input filebuf
-	ifstream carStream, roadStream, crossStream, presetAnswerStream;
-    ofstream answerStream;
-	carStream.open(carPath, ios::in);
-	if (carStream.fail()) {
-		cout << "fail to read carPath" << endl;
-		assert(false);
-	}
+		cout << "carPath is " << carPath << std::endl;
+		cout << "roadPath is " << roadPath << std::endl;
+		cout << "crossPath is " << crossPath << std::endl;
+		cout << "presetAnswerPath is " << presetAnswerPath << endl;
 
-	roadStream.open(roadPath, ios::in);
-	if (roadStream.fail()) {
-		cout << "fail to read roadPath" << endl;
-		assert(false);
+		scheduler = new Scheduler(carPath, roadPath, crossPath, presetAnswerPath);
+		if (not saveScenarioPath.empty()) {
+			Scenario::save(*scheduler, saveScenarioPath);
+			cout << "scenario saved to " << saveScenarioPath << endl;
+			return 0;
+		}
+		if (needAnswer) {
+			answerPath = args[4];
+			cout << "answerPath is " << answerPath << std::endl;
+		}
 	}
 
-	crossStream.open(crossPath, ios::in);
-	if (crossStream.fail()) {
-		cout << "fail to read crossPath" << endl;
-		assert(false);
-	}
+	if (not telemetryPath.empty())
+		scheduler->telemetry.enable(1 << 16);
+	if (perfCounters and not scheduler->profiler.enableCounters())
+		cout << "perf counters unavailable" << endl;
+	if (not digestPath.empty() or not digestRefPath.empty())
+		scheduler->digest.open(digestPath, digestRefPath);
+	if (memoryReport)
+		scheduler->memory.enable();
 
-	presetAnswerStream.open(presetAnswerPath, ios::in);
-	if (presetAnswerStream.fail()) {
-		cout << "fail to read presetAnswerPath" << endl;
-		assert(false);
+	if (not judgePath.empty()) {
+		cout << "judgePath is " << judgePath << std::endl;
+		clock_t start = clock();
+		bool ok = scheduler->readAnswer(judgePath) and scheduler->judge();
+		cout << "Judge time: " << (clock() - start) * 1000 / CLOCKS_PER_SEC << " ms" << endl;
+		scheduler->profiler.report();
+		scheduler->digest.close();
+		if (not telemetryPath.empty())
+			scheduler->telemetry.dump(telemetryPath);
+		return ok ? 0 : 1;
 	}
 
-    answerStream.open(answerPath, ios::out);
-	if (answerStream.fail()) {
-		cout << "fail to read answerPath" << endl;
-		assert(false);
-	}
+	AnswerWriter answerWriter(answerPath);
+	answerWriter.roadIds = scheduler->graph.roadIds();
 
-	auto scheduler = new Scheduler(carStream, roadStream, crossStream, presetAnswerStream);
+	scheduler->lookahead.horizon = lookahead;
+	scheduler->refresh.threshold = refreshThreshold;
+	if (refreshMaxStale > 0)
+		scheduler->refresh.maxStale = refreshMaxStale;
+	scheduler->departure.enabled = capacityDeparture;
+	scheduler->forecast.horizon = forecastHorizon;
+	scheduler->presetCachePath = presetCachePath;
+	scheduler->planner.k = planRoutes;
+	scheduler->planner.yen = yenPaths;
+	scheduler->planner.threads = pathThreads;
+	if (globalLoad > 0)
+		scheduler->departure.globalLoad = globalLoad;
+	if (regionSize > 0)
+		scheduler->departure.regionSize = regionSize;
+	scheduler->traceStatus = traceStatus;
+	scheduler->traceLog = traceLog;
+	scheduler->deadCycle = deadCycle;
 
 	cout << "Begin simulating" << endl;
 	scheduler->changeTenPercent();
+	if (streamAnswer) {
+		answerWriter.streaming = true;
+		answerWriter.writeHeader();
+		scheduler->answerWriter = &answerWriter;
+	}
     scheduler->simulate();
-	scheduler->outputAnswer(answerStream);
+	scheduler->outputAnswer(answerWriter);
+	scheduler->profiler.report();
+	scheduler->digest.close();
+	scheduler->memory.sample(*scheduler);
+	scheduler->memory.report();
+	if (not telemetryPath.empty())
+		scheduler->telemetry.dump(telemetryPath);
+	scheduler->trace.close();
 	return 0;
 }
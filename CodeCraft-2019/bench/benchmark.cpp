@@ -0,0 +1,163 @@
+#include "common.h"
+#include "graph.h"
+#include "scheduler.h"
+#include <chrono>
+#include <new>
+#include <cstdlib>
+
+/*
+ * 统计堆分配次数，用于报告每次操作的分配数，
+ * new与delete同时替换，GCC对free的误报可以忽略
+ */
+#if defined(__GNUC__) and __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+static size_t allocCount = 0;
+
+void* operator new(size_t size) {
+	++allocCount;
+	void* p = malloc(size == 0 ? 1 : size);
+	if (p == nullptr)
+		throw bad_alloc();
+	return p;
+}
+
+void operator delete(void* p) noexcept {
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+	free(p);
+}
+
+/**
+ *  Benchmark对调度器中的热点函数分别计时。
+ *
+ *  每个用例由setup与op两部分组成，只有op计入耗时与分配数，
+ *  会修改路网的用例在setup中恢复到同一存档。
+ */
+class Benchmark {
+	Scheduler& s;
+	string mapName;
+
+	template<class Setup, class Op>
+	void measure(const char* name, int iterations, Setup setup, Op op) {
+		double totalNs = 0;
+		size_t totalAllocs = 0;
+		for (int i = 0; i < iterations; ++i) {
+			setup(i);
+			size_t allocBefore = allocCount;
+			auto start = chrono::steady_clock::now();
+			op(i);
+			auto stop = chrono::steady_clock::now();
+			totalAllocs += allocCount - allocBefore;
+			totalNs += chrono::duration<double, nano>(stop - start).count();
+		}
+		printf("%-12s %-24s %8d %14.0f %12.1f\n", mapName.c_str(), name, iterations,
+			totalNs / iterations, (double)totalAllocs / iterations);
+	}
+
+	/*
+	 * 恢复存档后重新开始一个时间片
+	 */
+	void restore() {
+		s.recoverFieldInfo(1);
+		Car::freshState(s.cars.size());
+		s.waiting = 0;
+	}
+
+public:
+	Benchmark(Scheduler& scheduler, const string& name): s(scheduler), mapName(name) {}
+
+	/*
+	 * 预跑warmup个时间片，使路网上有车辆，并保存存档
+	 */
+	void warmup(int ticks) {
+		s.initNetwork();
+		s.curTime = 0;
+		for (int t = 0; t < ticks; ++t) {
+			s.updateRoadJam();
+			s.updateNextRoadSet();
+			if (not s.run()) {
+				Car::freshState(s.cars.size());
+				break;
+			}
+			++s.curTime;
+		}
+		s.updateRoadJam();
+		s.updateNextRoadSet();
+		s.saveFieldInfo();
+	}
+
+	void runAll(int iterations) {
+		Graph& graph = s.graph;
+		int carNum = (int)s.cars.size();
+		auto noSetup = [](int) {};
+
+		measure("floyd", max(1, iterations / 10), noSetup, [&](int) {
+			graph.floyd();
+		});
+		measure("dijkstra", iterations, noSetup, [&](int i) {
+			int carIdx = (i * 7919) % carNum;
+			graph.dijkstra(Car::getHot(carIdx), s.cars[carIdx].src, s.cars[carIdx].dest, -1);
+		});
+		measure("dijkstraForPrior", iterations, noSetup, [&](int i) {
+			int carIdx = (i * 7919) % carNum;
+			graph.dijkstraForPrior(Car::getHot(carIdx), s.cars[carIdx].src, s.cars[carIdx].dest);
+		});
+		measure("updateRoadJam", iterations, noSetup, [&](int) {
+			s.updateRoadJam();
+		});
+		measure("initWaitList", iterations, [&](int) {
+			restore();
+		}, [&](int) {
+			s.initWaitList();
+		});
+		measure("updateCrossCars(sweep)", iterations, [&](int) {
+			restore();
+			s.initWaitList();
+			s.driveJustCurrentRoad();
+			s.driveCarInitList(true);
+		}, [&](int) {
+			for (int crossIdx = 0; crossIdx < (int)graph.crosses.size(); ++crossIdx)
+				s.updateCrossCars(crossIdx);
+		});
+		measure("run(tick)", iterations, [&](int) {
+			restore();
+		}, [&](int) {
+			s.run();
+		});
+	}
+};
+
+/*
+ * 用法：CodeCraft-2019-bench [--iterations=N] [--warmup=T] [mapDir...]
+ * mapDir中包含car.txt、road.txt、cross.txt、presetAnswer.txt，
+ * 默认为../config
+ */
+int main(int argc, char *argv[]) {
+	int iterations = 20, warmupTicks = 100;
+	vector<string> mapDirs;
+	for (int i = 1; i < argc; ++i) {
+		if (strncmp(argv[i], "--iterations=", 13) == 0)
+			iterations = max(1, atoi(argv[i] + 13));
+		else if (strncmp(argv[i], "--warmup=", 9) == 0)
+			warmupTicks = atoi(argv[i] + 9);
+		else
+			mapDirs.emplace_back(argv[i]);
+	}
+	if (mapDirs.empty())
+		mapDirs.emplace_back("../config");
+
+	printf("%-12s %-24s %8s %14s %12s\n", "map", "benchmark", "iters", "ns/op", "allocs/op");
+	for (const string& dir : mapDirs) {
+		Scheduler* scheduler = new Scheduler(dir + "/car.txt", dir + "/road.txt", dir + "/cross.txt",
+			dir + "/presetAnswer.txt");
+		string name = dir.substr(dir.find_last_of('/') + 1);
+		Benchmark bench(*scheduler, name);
+		bench.warmup(warmupTicks);
+		bench.runAll(iterations);
+		delete scheduler;
+	}
+	return 0;
+}
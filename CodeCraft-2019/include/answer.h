@@ -0,0 +1,49 @@
+#ifndef __ANSWER_H__
+#define __ANSWER_H__
+
+#include "common.h"
+#include "route.h"
+
+/**
+ *  AnswerWriter将答案格式化到大块缓冲区中，
+ *  缓冲区满时才调用一次write写入文件。
+ *
+ *  streaming模式下，车辆到达终点后先记入pending，
+ *  当其到达时间早于不可再回滚的存档时间即写出，
+ *  使输出与调度过程重叠，回滚时丢弃尚未确认的记录。
+ */
+class AnswerWriter {
+	int fd;
+	vector<char> buffer;
+	size_t used;
+	vector<pair<int, int>> pending;	// (到达时间, 车辆idx)
+
+	void reserve(size_t n) {
+		if (used + n > buffer.size())
+			flush();
+		if (n > buffer.size())
+			buffer.resize(n);
+	}
+
+public:
+	bool streaming;
+	int maxRollback;	// streaming模式下允许回滚的存档数
+	vector<int> roadIds;	// 道路idx到id，写出时还原路径
+
+	explicit AnswerWriter(const string& path);
+	~AnswerWriter();
+	AnswerWriter(const AnswerWriter&) = delete;
+	AnswerWriter& operator=(const AnswerWriter&) = delete;
+
+	void writeHeader();
+	void writeCar(int id, int startTime, const RouteRef& route);
+	void flush();
+
+	void onCarEnd(int carIdx, int reachTime) {
+		pending.emplace_back(reachTime, carIdx);
+	}
+	void rollback(int time);
+	vector<int> commit(int time);
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define __CAR_H__
 
 #include "common.h"
+#include "route.h"
 
 #define NOT_DECIDED 0x3f3f3f3f
 #define DESTINATION 0x2f2f2f2f
@@ -10,6 +11,10 @@
 enum State {READY, WAITING, STOP};
 enum Location {HOME, ROAD, END};
 
+/*
+ * from、to为路口idx，nowRoad为道路idx，
+ * nowRoadIdx为当前道路在路径中的位置
+ */
 struct CarState {
 	int from;
 	int to;
@@ -19,39 +24,88 @@ struct CarState {
 	int nowRoad;
 	int nowRoadIdx;
 	int waitFor;
+	int decidedRoadIdx;		// 整路径规划时最近一次决策所在的nowRoadIdx
 
 	CarState() {
 		from = to = offset = laneIdx = nowRoad = -1;
 		location = HOME;
 		waitFor = NOT_DECIDED;
-		nowRoadIdx = -1;
+		nowRoadIdx = decidedRoadIdx = -1;
 	}
 };
 
+/*
+ * 调度中逐车读取的字段，打包为8字节单独成列，
+ * 扫描车道与路口时只访问这一列
+ */
+struct CarHot {
+	int maxSpeed;
+	bool prior;
+	bool preset;
+	bool reset;
+};
+
+static_assert(sizeof(CarHot) == 8, "CarHot should stay packed in 8 bytes");
+
+/**
+ *  cars中只保留较少访问的字段，
+ *  maxSpeed、prior、preset、reset存于hots列，
+ *  与states等列一样按车辆idx通过静态函数访问。
+ *
+ *  载入后src、dest为路口idx，nextRoads与routes为道路idx，
+ *  只在写出答案、状态摘要与场景文件时还原为id。
+ */
 class Car {
 public:
 	static vector<enum State> states;
 	static vector<int> nextRoads;
 	static vector<CarState> instantStates;
+	static RoutePool routes;
+	static vector<CarHot> hots;
 	int id;
 	int src;
 	int dest;
-	int maxSpeed;
 	int planTime;
-	bool prior;
-	bool preset;
-	bool reset;
 
 	int startTime;
 	int reachTime;
 	int goTime;
-	vector<int> route;
 
-	explicit Car(vector<int> v): id(v[0]), src(v[1]), dest(v[2]), maxSpeed(v[3]), planTime(v[4]), startTime(INF) {
-		prior = v[5] == 1;
-		preset = v[6] == 1;
+	/*
+	 * v为(id，起点，终点，最高速度，计划出发时间，是否优先，是否预置)，
+	 * 起点与终点为路口id，由载入方换为idx
+	 */
+	explicit Car(const int* v): id(v[0]), src(v[1]), dest(v[2]), planTime(v[4]), startTime(INF) {
 		reachTime = goTime = INF;
-		reset = false;
+	}
+
+	static CarHot makeHot(const int* v) {
+		CarHot hot;
+		hot.maxSpeed = v[3];
+		hot.prior = v[5] == 1;
+		hot.preset = v[6] == 1;
+		hot.reset = false;
+		return hot;
+	}
+
+	static const CarHot& getHot(int idx) {
+		return hots[idx];
+	}
+
+	static int& getMaxSpeed(int idx) {
+		return hots[idx].maxSpeed;
+	}
+
+	static bool& getPrior(int idx) {
+		return hots[idx].prior;
+	}
+
+	static bool& getPreset(int idx) {
+		return hots[idx].preset;
+	}
+
+	static bool& getReset(int idx) {
+		return hots[idx].reset;
 	}
 
 	/**
@@ -106,11 +160,16 @@ public:
 		return instantStates[idx].nowRoadIdx;
 	}
 
+	static RouteRef getRoute(int idx) {
+		return RouteRef(routes, idx);
+	}
+
 	static void initState(size_t sz) {
 		states.assign(sz, READY);
 		nextRoads.assign(sz, NOT_DECIDED);
 		CarState initialCarState;
 		instantStates.assign(sz, initialCarState);
+		routes.init(sz);
 	}
 
 	static void freshState(size_t sz) {
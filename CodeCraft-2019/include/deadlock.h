@@ -0,0 +1,44 @@
+#ifndef __DEADLOCK_H__
+#define __DEADLOCK_H__
+
+#include "common.h"
+
+/**
+ *  WaitForGraph记录路口调度中车道间的等待关系。
+ *
+ *  结点为有向道路(道路序号*2 + 方向，0为正向，1为反向)，
+ *  表示该方向驶入路口的车道组。
+ *  每个结点至多一条出边，指向阻挡其第一优先级车辆的结点：
+ *  	路口冲突时为冲突道路驶入方向，
+ *  	下一道路末尾车辆等待时为下一道路驶出方向。
+ *
+ *  结点每次有车辆通过路口，epoch加一，
+ *  此前指向它的边随之失效。
+ *  加边时沿出边链检查是否回到自身，即可增量发现死锁环。
+ */
+class WaitForGraph {
+	vector<int> waitFor;		// 出边目标结点，-1表示无
+	vector<int> waitEpoch;		// 加边时目标结点的epoch
+	vector<int> epoch;
+
+public:
+	vector<int> cycle;			// 最近一次发现的死锁环
+
+	static int node(int roadIdx, bool forward) {
+		return roadIdx * 2 + (forward ? 0 : 1);
+	}
+
+	static int roadOf(int node) {
+		return node / 2;
+	}
+
+	static bool forwardOf(int node) {
+		return node % 2 == 0;
+	}
+
+	void reset(int nodeNum);
+	void progress(int node);
+	bool block(int node, int blocker);
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef __DEPARTURE_H__
+#define __DEPARTURE_H__
+
+#include "common.h"
+
+class Scheduler;
+
+/**
+ *  DepartureController按路网容量决定车辆能否从车库出发，
+ *  替代readyToGo中基于goCarSize的经验额度。
+ *
+ *  路口按detectEdge得到的坐标划分为regionSize * regionSize的区域，
+ *  有向道路归入其驶入路口所在区域，区域容量为length * laneNumber之和。
+ *  每个时间片开始时统计各区域路上与待出发的车辆数：
+ *  	占用率低于lowWater时区域开放，高于highWater时关闭，
+ *  	开放期间可一次放出多辆车直到highWater，
+ *  全网在途车辆数不超过globalLoad * totalCapacity。
+ *  发生死锁时按比例收紧所有上限，之后无死锁的时间片逐步放宽。
+ */
+class DepartureController {
+	vector<int> crossRegion;	// 路口idx所在区域
+	vector<int> nodeRegion;		// 有向道路(roadIdx * 2 + 反向)所在区域
+	vector<int> capacity;
+	vector<int> occupancy;
+	vector<char> open;			// 区域是否开放
+	int totalCapacity;
+	int budget;					// 本时间片全网剩余出发额度
+	double scale;
+
+public:
+	bool enabled;
+	int regionSize;
+	double lowWater, highWater;
+	double globalLoad;
+
+	int released, denied, deadBlocks;
+
+	DepartureController(): totalCapacity(0), budget(0), scale(1), enabled(false), regionSize(4),
+		lowWater(0.2), highWater(0.35), globalLoad(0.3), released(0), denied(0), deadBlocks(0) {}
+
+	void init(const Scheduler&);
+	void begin(const Scheduler&);
+	bool admit(int srcCrossIdx, bool prior);
+	void onDeadBlock();
+	void onTick();
+	void report() const;
+};
+
+#endif
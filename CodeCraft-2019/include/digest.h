@@ -0,0 +1,72 @@
+#ifndef __DIGEST_H__
+#define __DIGEST_H__
+
+#include "common.h"
+#include <cstdint>
+
+/*
+ * 64位FNV-1a，按整数而非字节累加，输出前再做一次混合
+ */
+struct StateHasher {
+	uint64_t h;
+
+	StateHasher(): h(0xcbf29ce484222325ULL) {}
+
+	void add(uint64_t v) {
+		h = (h ^ v) * 0x100000001b3ULL;
+	}
+
+	void add(const int* begin, const int* end) {
+		add((uint64_t)(end - begin));
+		for (const int* p = begin; p != end; ++p)
+			add((uint64_t)(uint32_t)*p);
+	}
+
+	void add(double v) {
+		uint64_t bits;
+		memcpy(&bits, &v, sizeof(bits));
+		add(bits);
+	}
+
+	uint64_t value() const {
+		uint64_t x = h;
+		x ^= x >> 33;
+		x *= 0xff51afd7ed558ccdULL;
+		x ^= x >> 33;
+		return x;
+	}
+};
+
+struct DigestEntry {
+	int phase;
+	int time;
+	uint64_t hash;
+};
+
+/**
+ *  StateDigest逐个时间片写出状态摘要，每行为(序号，阶段，时间，摘要)，
+ *  并与参考文件中同一序号的记录比较。
+ *  回滚后重跑的时间片也各占一个序号，因此两次运行的序列应完全一致。
+ */
+class StateDigest {
+	FILE* out;
+	vector<DigestEntry> reference;
+	int seq;
+	bool on;
+
+public:
+	StateDigest(): out(nullptr), seq(0), on(false) {}
+	~StateDigest() {
+		close();
+	}
+
+	bool enabled() const {
+		return on;
+	}
+
+	void open(const string& outPath, const string& referencePath);
+	bool check(int phase, int time, uint64_t hash);
+	void close();
+};
+
+#endif
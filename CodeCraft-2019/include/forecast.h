@@ -0,0 +1,66 @@
+#ifndef __FORECAST_H__
+#define __FORECAST_H__
+
+#include "common.h"
+
+class Scheduler;
+
+/**
+ *  JamForecast预测每条有向道路未来horizon个时间片内的车辆数。
+ *
+ *  路上车辆按当前速度驶完本道路，之后沿已决定的路径行驶，
+ *  路径用完后按floyd的next表选择下一道路，每条道路按全速通过；
+ *  已决定出发的车辆与horizon内出发的预置车辆从起点开始计入。
+ *  车库中尚无路径的车辆不计入，包括尚未决定的非预置车辆
+ *  与被修改、路径已清空的预置车辆。
+ *  不考虑排队与车道容量，只作为道路权重中拥堵程度的估计。
+ *
+ *  load[node * (horizon + 1) + h]为h个时间片后node上的车辆数。
+ *  h = 0时除路上车辆外还包括本时间片出发的车库车辆，
+ *  因此不小于当前forJam、backJam。
+ */
+class JamForecast {
+	struct RoadInfo {
+		int length;
+		int speed;
+		int from;	// 起点路口idx
+		int to;		// 终点路口idx
+	};
+
+	vector<RoadInfo> roads;
+	vector<int> roadBetween;	// roadBetween[i*n+j]为从路口i驶向j的道路idx
+	vector<int> carDest;		// 车辆终点路口idx
+	int crossNum;
+	vector<int> load;
+
+	void project(const Scheduler&, int carIdx, int node, int remain, int routePos, int t);
+
+public:
+	int horizon;				// 0表示关闭
+
+	JamForecast(): crossNum(0), horizon(0) {}
+
+	void init(const Scheduler&);
+	void build(const Scheduler&);
+
+	/*
+	 * 车辆eta个时间片后驶入道路时该有向道路上的预计车辆数
+	 */
+	int jam(int roadIdx, bool forward, double eta) const {
+		int h = min(horizon, max(0, (int)(eta + 0.5)));
+		return load[(roadIdx * 2 + (forward ? 0 : 1)) * (horizon + 1) + h];
+	}
+
+	/*
+	 * horizon内的平均车辆数，供不区分到达时间的floyd使用
+	 */
+	double meanJam(int roadIdx, bool forward) const {
+		const int* p = &load[(roadIdx * 2 + (forward ? 0 : 1)) * (horizon + 1)];
+		int sum = 0;
+		for (int h = 0; h <= horizon; ++h)
+			sum += p[h];
+		return (double)sum / (horizon + 1);
+	}
+};
+
+#endif
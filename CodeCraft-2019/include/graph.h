@@ -2,6 +2,8 @@
 #define __GRAPH_H__
 
 #include "common.h"
+#include "idindex.h"
+#include <array>
 
 
 struct Road {
@@ -12,6 +14,10 @@ struct Road {
 	int startId;
 	int endId;
 	bool duplex;
+	int from;		// 起点路口idx
+	int to;			// 终点路口idx
+	int startSlot;	// 在起点路口中的方向，未登记时为-1
+	int endSlot;	// 在终点路口中的方向，未登记时为-1
 	
 	int forJam;
 	int backJam;
@@ -24,48 +30,68 @@ struct Road {
 	double penalty;
 };
 
+/*
+ * 四个方向从北方道路开始顺时针，没有道路处为-1：
+ * roads为道路id，roadIdxs为道路idx，
+ * neighbors为经该道路驶出到达的路口idx，不能驶出时为-1，
+ * kinds为从该道路驶入时的路口类型，由linkCrosses()预先算好
+ */
 struct Cross {
 	int id;
-	vector<int> roads;
+	array<int, 4> roads;
+	array<int, 4> roadIdxs;
+	array<int, 4> neighbors;
+	array<char, 4> kinds;
+	bool edge;
 	int waitCarNum;
 
 	int x, y;
-	bool edge;
 	int gapNum;
 };
 
-class Car;
+struct CarHot;
+class JamForecast;
 
 class Graph {
 	vector<Cross> crosses;
 	vector<Road> roads;
 	int totalCapacity;
-	unordered_map<int, int> crossIdx;
-	unordered_map<int, int> roadIdx;
+	IdIndex crossIdx;
+	IdIndex roadIdx;
 
-	/*
-	 * hash为从(crossId, crossId)二元组到
-	 * 连接这两个cross的道路索引即idx的映射
-	 * */
-	map<pair<int, int>, int> hash;
 
-
-	double getRoadWeight(const Road&, const Car&, bool);
+	double getRoadWeight(const Road&, const CarHot&, bool);
+	double travelTime(const Road&, const CarHot&);
+	void applyForecast(Road&, int, double);
 	double getRoadFloydWeight(const Road&, bool);
 
 public:
 	
 	friend class Scheduler;
 	friend class Simulator;
-
-	Graph(ifstream&, ifstream&);
+	friend class Lookahead;
+	friend class Scenario;
+	friend class Benchmark;
+	friend class MemoryStats;
+	friend class DepartureController;
+	friend class JamForecast;
+	friend class RoutePlanner;
+	friend class PathStore;
+
+	const JamForecast* forecast;	// 非空时按预测车辆数计算道路权重
+
+	Graph(): totalCapacity(0), forecast(nullptr) {}
+	Graph(const string&, const string&);
+	void indexRoadsAndCrosses();
+	void linkCrosses();
 	void displayRoads();
 	void displayCrosses();
 	pair<vector<vector<double>>, vector<vector<int>>> floyd();
-	int dijkstra(Car&, int, int, int);
+	int dijkstra(const CarHot&, int, int, int);
 
 	vector<int> prevToRoute(const vector<int>&, int, int);
-	vector<int> dijkstraForPrior(Car&);
+	vector<int> dijkstraForPrior(const CarHot&, int, int);
+	vector<int> roadIds() const;
 
 	void setKeyRoad();
 
@@ -74,10 +100,11 @@ public:
 
 	int getRoadIdx(int id);
 	int getCrossRoadIdx(int crossId1, int crossId2);
+	int getLinkRoadIdx(int crossIdx1, int crossIdx2);
 	int getCrossIdx(int id);
 
     bool isRoadCongested(int, int);
-	int getCrossKind(int, int);
+	int getCrossKind(int crossIdx, int slot);
 
 	vector<vector<int>> naiveFloyd();
 	void detectEdge();
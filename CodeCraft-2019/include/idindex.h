@@ -0,0 +1,101 @@
+#ifndef __IDINDEX_H__
+#define __IDINDEX_H__
+
+#include "common.h"
+
+/**
+ *  IdIndex把id映射为连续的idx，载入时由全部id一次建立。
+ *
+ *  id的跨度不超过个数的denseFactor倍时，以id - base为下标的数组保存idx，
+ *  不存在的id为-1，查找只需一次减法与一次数组访问；
+ *  否则按id排序保存(id, idx)，二分查找，内存只与个数有关。
+ *  同一id出现多次时以最后一次为准。
+ */
+class IdIndex {
+	static const int denseFactor = 4;
+
+	int base;
+	int count;
+	vector<int> table;				// 稠密时使用
+	vector<pair<int, int>> sorted;	// 稀疏时使用，按id升序
+
+public:
+	IdIndex(): base(0), count(0) {}
+
+	void clear() {
+		base = count = 0;
+		table.clear();
+		sorted.clear();
+	}
+
+	/*
+	 * ids[i]为idx i的id
+	 */
+	void build(const vector<int>& ids) {
+		clear();
+		if (ids.empty())
+			return;
+		int minId = *min_element(ids.begin(), ids.end());
+		int maxId = *max_element(ids.begin(), ids.end());
+		if ((long long)maxId - minId + 1 <= (long long)denseFactor * (long long)ids.size()) {
+			base = minId;
+			table.assign(maxId - minId + 1, -1);
+			for (int i = 0; i < (int)ids.size(); ++i) {
+				if (table[ids[i] - base] == -1)
+					++count;
+				table[ids[i] - base] = i;
+			}
+			return;
+		}
+		sorted.reserve(ids.size());
+		for (int i = 0; i < (int)ids.size(); ++i)
+			sorted.emplace_back(ids[i], i);
+		stable_sort(sorted.begin(), sorted.end(), [](const pair<int, int>& a, const pair<int, int>& b)->bool {
+			return a.first < b.first;
+		});
+		int n = 0;
+		for (int i = 0; i < (int)sorted.size(); ++i) {
+			if (n > 0 and sorted[n - 1].first == sorted[i].first)
+				sorted[n - 1] = sorted[i];
+			else
+				sorted[n++] = sorted[i];
+		}
+		sorted.resize(n);
+		sorted.shrink_to_fit();
+		count = n;
+	}
+
+	/*
+	 * 不存在时返回-1
+	 */
+	int find(int id) const {
+		if (sorted.empty()) {
+			unsigned offset = (unsigned)id - (unsigned)base;
+			return offset < table.size() ? table[offset] : -1;
+		}
+		auto it = lower_bound(sorted.begin(), sorted.end(), id, [](const pair<int, int>& p, int v)->bool {
+			return p.first < v;
+		});
+		return it != sorted.end() and it->first == id ? it->second : -1;
+	}
+
+	int at(int id) const {
+		int idx = find(id);
+		assert(idx != -1);
+		return idx;
+	}
+
+	int operator[](int id) const {
+		return at(id);
+	}
+
+	int size() const {
+		return count;
+	}
+
+	size_t bytes() const {
+		return table.capacity() * sizeof(int) + sorted.capacity() * sizeof(pair<int, int>);
+	}
+};
+
+#endif
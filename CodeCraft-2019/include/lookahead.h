@@ -0,0 +1,78 @@
+#ifndef __LOOKAHEAD_H__
+#define __LOOKAHEAD_H__
+
+#include "common.h"
+#include "deadlock.h"
+#include <future>
+#include <memory>
+
+class Scheduler;
+
+/**
+ *  Lookahead在后台线程上用简化模型向前推演路网horizon个时间片，
+ *  预测是否即将出现死锁，以便提前收紧出发车辆数goCarSize。
+ *
+ *  影子模型只保留有向道路上车辆的先后次序：
+ *  	每条有向道路容量为length * laneNumber，
+ *  	车辆按offset从前到后排列，同车道前车近似为前laneNumber辆，
+ *  	到达路口时下一有向道路已满则停在路口。
+ *  若某时刻停在路口的车道沿“下一道路”形成环，即视为死锁。
+ *
+ *  快照在主线程上拷贝，之后后台线程只读写快照本身，
+ *  结果在下一时间片开始时取回，保证调度结果可复现。
+ *  next表只在调度器重建后拷贝一次，各快照共享只读副本。
+ */
+class Lookahead {
+	struct ShadowRoad {
+		int length;
+		int lanes;
+		int speed;
+		int from;	// 起点路口idx
+		int to;		// 终点路口idx
+	};
+
+	struct ShadowCar {
+		int offset;
+		int speed;
+		int dest;		// 终点路口idx
+		int routePos;	// 固定路径在routeData中的当前位置，-1表示按next决策
+		int routeEnd;
+		int startTime;	// 仍在车库中车辆的出发时间
+	};
+
+	struct Snapshot {
+		vector<vector<ShadowCar>> nodes;	// 每条有向道路上的车辆，从前到后
+		vector<ShadowCar> garage;			// 即将出发的车辆
+		vector<int> garageNode;
+		vector<int> routeData;				// 固定路径上的道路idx
+		shared_ptr<const vector<vector<int>>> next;
+	};
+
+	vector<ShadowRoad> roads;
+	vector<int> roadBetween;	// roadBetween[i*n+j]为连接路口i与j的道路idx
+	int crossNum;
+
+	future<int> pending;
+	shared_ptr<const vector<vector<int>>> next;
+	int nextVersion;			// next对应的调度器next版本
+
+	int nextNode(const Snapshot&, const ShadowCar&, int node) const;
+	int capacity(int node) const;
+	int run(Snapshot) const;
+
+public:
+	int horizon;				// 推演时间片数，0表示关闭
+	int throttle;				// 预测到死锁时goCarSize的减少量
+	int predicted;				// 预测到死锁的次数
+
+	Lookahead(): crossNum(0), nextVersion(-1), horizon(0), throttle(1000), predicted(0) {}
+
+	void init(const Scheduler&);
+	void start(const Scheduler&);
+	int collect();
+	bool busy() const {
+		return pending.valid();
+	}
+};
+
+#endif
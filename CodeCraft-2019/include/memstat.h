@@ -0,0 +1,51 @@
+#ifndef __MEMSTAT_H__
+#define __MEMSTAT_H__
+
+#include "common.h"
+
+class Scheduler;
+struct RoadSimulator;
+
+enum MemSubsystem {
+	MEM_NETWORK,		// network中的车道
+	MEM_FIELD_INFO,		// fieldInfoList中的存档
+	MEM_ROUTING,		// dist与next矩阵，以及候选路径
+	MEM_ROUTES,			// 车辆路径池
+	MEM_HASH,			// id到idx的映射表
+	MEM_CARS,			// cars与车辆状态数组
+	MEM_SUBSYSTEM_NUM
+};
+
+/**
+ *  MemoryStats遍历调度器的各个容器估算其占用的堆内存，
+ *  按libstdc++的节点与分块大小计算，不含分配器自身开销。
+ *  每次存档时采样一次，记录各子系统的当前值与峰值，
+ *  结束时与进程的峰值RSS一起输出。
+ */
+class MemoryStats {
+	size_t live[MEM_SUBSYSTEM_NUM];
+	size_t peak[MEM_SUBSYSTEM_NUM];
+	size_t peakTotal;
+	int peakTime;
+	int samples;
+	bool on;
+
+public:
+	MemoryStats(): live(), peak(), peakTotal(0), peakTime(0), samples(0), on(false) {}
+
+	void enable() {
+		on = true;
+	}
+
+	bool enabled() const {
+		return on;
+	}
+
+	void sample(const Scheduler&);
+	void report() const;
+
+	static size_t dequeBytes(const deque<int>&);
+	static size_t networkBytes(const vector<RoadSimulator>&);
+};
+
+#endif
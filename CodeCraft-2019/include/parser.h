@@ -0,0 +1,126 @@
+#ifndef __PARSER_H__
+#define __PARSER_H__
+
+#include "common.h"
+#include <thread>
+
+/**
+ *  MappedFile将输入文件只读映射到内存，
+ *  避免getline逐行拷贝。
+ */
+class MappedFile {
+	int fd;
+	char* data;
+	size_t length;
+
+public:
+	explicit MappedFile(const string& path);
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const char* begin() const { return data; }
+	const char* end() const { return data + length; }
+	size_t size() const { return length; }
+};
+
+/**
+ *  TupleReader逐行扫描"(a, b, c, ...)"格式的元组，
+ *  跳过空行与#开头的注释行，直接在映射内存上解析整数。
+ */
+class TupleReader {
+	const char* p;
+	const char* lineEnd;
+	const char* fileEnd;
+
+public:
+	TupleReader(const char* begin, const char* end): p(begin), lineEnd(begin), fileEnd(end) {}
+	explicit TupleReader(const MappedFile& file): TupleReader(file.begin(), file.end()) {}
+
+	/*
+	 * 定位到下一条元组，文件结束返回false
+	 */
+	bool nextLine() {
+		p = lineEnd;
+		while (p < fileEnd) {
+			while (p < fileEnd and (*p == '\n' or *p == '\r' or *p == ' ' or *p == '\t'))
+				++p;
+			if (p == fileEnd)
+				break;
+			const char* eol = (const char*)memchr(p, '\n', fileEnd - p);
+			lineEnd = eol == nullptr ? fileEnd : eol;
+			if (*p != '#')
+				return true;
+			p = lineEnd;
+		}
+		lineEnd = fileEnd;
+		return false;
+	}
+
+	/*
+	 * 读取当前元组的下一个整数，行尾返回false
+	 */
+	bool nextInt(int& v) {
+		while (p < lineEnd and *p != '-' and (*p < '0' or *p > '9'))
+			++p;
+		if (p == lineEnd)
+			return false;
+		bool negative = (*p == '-');
+		if (negative)
+			++p;
+		int x = 0;
+		while (p < lineEnd and *p >= '0' and *p <= '9')
+			x = x * 10 + (*p++ - '0');
+		v = negative ? -x : x;
+		return true;
+	}
+
+	/*
+	 * 读取当前元组的前n个整数，不足n个返回false
+	 */
+	bool nextInts(int* v, int n) {
+		for (int i = 0; i < n; ++i) {
+			if (not nextInt(v[i]))
+				return false;
+		}
+		return true;
+	}
+};
+
+/*
+ * 将[begin, end)按行边界切分为至多n段，
+ * 每段不少于minBytes字节
+ */
+vector<pair<const char*, const char*>> splitLines(const char* begin, const char* end, int n, size_t minBytes);
+
+/**
+ *  将文件按行切分后多线程解析，
+ *  每段由parse(TupleReader&, Chunk&)写入各自的缓冲区，
+ *  返回的缓冲区按文件中的先后顺序排列。
+ */
+template<class Chunk, class Parse>
+vector<Chunk> parseChunks(const MappedFile& file, Parse parse) {
+	const size_t minBytes = 1 << 18;
+	int n = max(1, (int)thread::hardware_concurrency());
+	auto ranges = splitLines(file.begin(), file.end(), n, minBytes);
+	vector<Chunk> chunks(ranges.size());
+	if (ranges.size() <= 1) {
+		for (int i = 0; i < (int)ranges.size(); ++i) {
+			TupleReader reader(ranges[i].first, ranges[i].second);
+			parse(reader, chunks[i]);
+		}
+		return chunks;
+	}
+	vector<thread> workers;
+	for (int i = 0; i < (int)ranges.size(); ++i) {
+		workers.emplace_back([&ranges, &chunks, &parse, i]() {
+			TupleReader reader(ranges[i].first, ranges[i].second);
+			parse(reader, chunks[i]);
+		});
+	}
+	for (thread& worker : workers)
+		worker.join();
+	return chunks;
+}
+
+#endif
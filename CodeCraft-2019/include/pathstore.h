@@ -0,0 +1,89 @@
+#ifndef __PATHSTORE_H__
+#define __PATHSTORE_H__
+
+#include "common.h"
+#include <cstdint>
+
+class Graph;
+
+/**
+ *  PathStore保存各(起点路口，终点路口)的候选路径。
+ *
+ *  路径以有向道路(roadIdx * 2 + 反向)表示，所有路径连续存于nodes，
+ *  第i条路径为nodes[pathStart[i], pathStart[i + 1])，
+ *  同一对路口的路径序号连续。
+ *
+ *  候选路径有两种生成方式：
+ *  	penaltyPaths：求最短路后放大已用道路的权重再求，得到相互错开的路径；
+ *  	yenPaths：Yen算法求前k条无环最短路，按自由行驶时间升序排列。
+ *  build()对给定的所有路口对用多个线程并行计算Yen路径，
+ *  各线程写入各自的结果，合并时按路口对的顺序追加，结果与线程数无关。
+ */
+class PathStore {
+	struct Edge {
+		int node;		// 有向道路
+		int to;			// 驶入的路口idx
+	};
+
+	vector<vector<Edge>> adj;
+	vector<int> nodeFrom;		// 有向道路的驶出路口idx
+	vector<int> nodeTo;			// 有向道路的驶入路口idx
+	vector<double> freeTime;	// 有向道路的自由行驶时间
+	vector<int> nodeCapacity;	// 有向道路的length * laneNumber
+	unordered_map<int64_t, pair<int, int>> odPaths;	// (首条路径序号，路径数)
+	vector<int> nodes;
+	vector<int> pathStart;
+	int crossNum;
+
+	vector<int> shortest(int src, int dest, const vector<double>& weight,
+		const vector<char>* bannedNode, const vector<char>* bannedCross) const;
+	double cost(const vector<int>& path) const;
+
+public:
+	PathStore(): crossNum(0) {
+		pathStart.emplace_back(0);
+	}
+
+	void init(const Graph&);
+
+	vector<vector<int>> penaltyPaths(int src, int dest, int k, double diversity) const;
+	vector<vector<int>> yenPaths(int src, int dest, int k) const;
+
+	/*
+	 * ods中的路口对去重后并行计算Yen路径，threads为0时按硬件线程数
+	 */
+	void build(const vector<pair<int, int>>& ods, int k, int threads);
+
+	/*
+	 * 返回(首条路径序号，路径数)，未保存时路径数为-1
+	 */
+	pair<int, int> find(int src, int dest) const;
+	pair<int, int> add(int src, int dest, const vector<vector<int>>& paths);
+
+	/*
+	 * 按道路当前车辆数选择最空闲的候选路径：
+	 * 比较路径上最拥挤道路的占用率，相同时取自由行驶时间短的。
+	 * 第一条道路不能为blockRoadIdx，没有可用候选时返回-1
+	 */
+	int leastLoaded(const Graph&, int src, int dest, int blockRoadIdx) const;
+
+	const int* begin(int path) const {
+		return nodes.data() + pathStart[path];
+	}
+
+	const int* end(int path) const {
+		return nodes.data() + pathStart[path + 1];
+	}
+
+	int pairs() const {
+		return (int)odPaths.size();
+	}
+
+	int paths() const {
+		return (int)pathStart.size() - 1;
+	}
+
+	size_t bytes() const;
+};
+
+#endif
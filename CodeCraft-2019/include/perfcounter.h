@@ -0,0 +1,41 @@
+#ifndef __PERFCOUNTER_H__
+#define __PERFCOUNTER_H__
+
+#include "common.h"
+#include <cstdint>
+
+enum PerfEvent {
+	PERF_CYCLES,
+	PERF_INSTRUCTIONS,
+	PERF_LLC_MISSES,
+	PERF_BRANCH_MISSES,
+	PERF_EVENT_NUM
+};
+
+/**
+ *  PerfCounters通过perf_event_open读取本线程的硬件计数器，
+ *  只统计用户态。打开失败的事件读数恒为0，
+ *  全部失败时enabled()为false，不影响调度。
+ *  非Linux平台上open总是失败。
+ */
+class PerfCounters {
+	int fds[PERF_EVENT_NUM];
+
+public:
+	PerfCounters() {
+		for (int i = 0; i < PERF_EVENT_NUM; ++i)
+			fds[i] = -1;
+	}
+	~PerfCounters() {
+		close();
+	}
+
+	bool open();
+	void close();
+	bool enabled() const;
+	void read(uint64_t values[PERF_EVENT_NUM]) const;
+
+	static const char* name(int event);
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef __PLANNER_H__
+#define __PLANNER_H__
+
+#include "common.h"
+#include "pathstore.h"
+
+class Graph;
+struct CarHot;
+
+/**
+ *  RoutePlanner为非优先车辆在出发时一次给出完整路径。
+ *
+ *  每个(起点路口，终点路口)有至多k条候选路径，存于PathStore：
+ *  默认在首次用到时由penaltyPaths生成；
+ *  yen为真时在调度开始前对所有待规划车辆的路口对并行求Yen路径。
+ *  出发时按当前道路权重之和选择最优候选，
+ *  行驶中只有下一道路拥堵时才从当前路口重新选择，
+ *  yen为真时重新选择按道路当前车辆数取最空闲的候选，
+ *  因此每经过一个路口只需读取路径中的下一道路。
+ */
+class RoutePlanner {
+	PathStore store;
+
+	pair<int, int> candidates(int src, int dest);
+	vector<int> roadIdxs(int path) const;
+
+public:
+	int k;						// 0表示关闭
+	double diversity;
+	bool yen;
+	int threads;				// 求Yen路径的线程数，0表示按硬件线程数
+
+	int planned, revised;
+
+	RoutePlanner(): k(0), diversity(0.5), yen(false), threads(0), planned(0), revised(0) {}
+
+	void init(const Graph&, const vector<pair<int, int>>& ods);
+
+	/*
+	 * 从路口src到dest选择当前代价最小的候选路径，返回道路idx，
+	 * 第一条道路不能为blockRoadIdx，没有可用候选时返回空
+	 */
+	vector<int> choose(Graph&, const CarHot&, int src, int dest, int blockRoadIdx);
+
+	/*
+	 * 行驶中下一道路拥堵时重新选择后续路径
+	 */
+	vector<int> reroute(Graph&, const CarHot&, int src, int dest, int blockRoadIdx);
+
+	size_t bytes() const {
+		return store.bytes();
+	}
+
+	void report() const;
+};
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#include "common.h"
+#include "perfcounter.h"
+#include <cstdint>
+#include <chrono>
+#if defined(__x86_64__) or defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+enum ProfPhase {
+	PROF_INIT_WAIT,			// initWaitList
+	PROF_DRIVE_CURRENT,		// driveJustCurrentRoad
+	PROF_INIT_LIST,			// driveCarInitList
+	PROF_WAIT_STATE,		// driveCarInWaitState
+	PROF_ROAD_JAM,			// updateRoadJam
+	PROF_NEXT_ROAD,			// updateNextRoadSet
+	PROF_SAVE,				// saveFieldInfo
+	PROF_RECOVER,			// recoverFieldInfo
+	PROF_PHASE_NUM
+};
+
+#ifdef PROFILE
+
+/*
+ * 单个时间片内各阶段的耗时(TSC周期)，phase为0表示只跑预置车辆的预演
+ */
+struct TickProfile {
+	int phase;
+	int time;
+	bool rolledBack;
+	uint64_t cycles[PROF_PHASE_NUM];
+};
+
+/**
+ *  Profiler按时间片累计各阶段的TSC周期数。
+ *  每个时间片结束时调用endTick保存一条记录，
+ *  回滚时将回滚点之后的记录标记为作废，
+ *  结束时report输出各阶段总耗时、分位数与作废时间片的占比。
+ *  enableCounters后同时累计各阶段的硬件计数器。
+ *  编译时未定义PROFILE则为空实现。
+ */
+class Profiler {
+	uint64_t cur[PROF_PHASE_NUM];
+	uint64_t events[PROF_PHASE_NUM][PERF_EVENT_NUM];	// 整个运行期间的累计值
+	vector<TickProfile> ticks;
+	vector<int> live;		// 未被回滚的时间片在ticks中的下标，时间递增
+	uint64_t startTsc;
+	chrono::steady_clock::time_point startClock;
+
+public:
+	PerfCounters counters;
+
+	Profiler(): cur(), events(), startTsc(now()), startClock(chrono::steady_clock::now()) {}
+
+	bool enableCounters() {
+		return counters.open();
+	}
+
+	static uint64_t now() {
+#if defined(__x86_64__) or defined(__i386__)
+		return __rdtsc();
+#else
+		return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(
+			chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	void add(int phase, uint64_t cycles) {
+		cur[phase] += cycles;
+	}
+
+	void addEvents(int phase, const uint64_t begin[PERF_EVENT_NUM], const uint64_t end[PERF_EVENT_NUM]) {
+		for (int i = 0; i < PERF_EVENT_NUM; ++i)
+			events[phase][i] += end[i] - begin[i];
+	}
+
+	void endTick(int phase, int time, bool dead);
+	void rollback(int time);
+	void report() const;
+	void reportCounters() const;
+};
+
+class ScopedTimer {
+	Profiler& profiler;
+	int phase;
+	bool counting;
+	uint64_t begin[PERF_EVENT_NUM];
+	uint64_t start;
+
+public:
+	ScopedTimer(Profiler& p, int ph): profiler(p), phase(ph), counting(p.counters.enabled()) {
+		if (counting)
+			profiler.counters.read(begin);
+		start = Profiler::now();
+	}
+	~ScopedTimer() {
+		profiler.add(phase, Profiler::now() - start);
+		if (counting) {
+			uint64_t end[PERF_EVENT_NUM];
+			profiler.counters.read(end);
+			profiler.addEvents(phase, begin, end);
+		}
+	}
+};
+
+#else
+
+class Profiler {
+public:
+	bool enableCounters() {
+		return false;
+	}
+	void endTick(int, int, bool) {}
+	void rollback(int) {}
+	void report() const {}
+};
+
+class ScopedTimer {
+public:
+	ScopedTimer(Profiler&, int) {}
+};
+
+#endif
+
+#endif
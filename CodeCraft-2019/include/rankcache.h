@@ -0,0 +1,30 @@
+#ifndef __RANKCACHE_H__
+#define __RANKCACHE_H__
+
+#include "common.h"
+#include <cstdint>
+
+/**
+ *  预置车辆排序缓存文件格式：
+ *  	RankCacheHeader
+ *  	ids		count个int，changeTenPercent排序后的预置车辆id
+ *
+ *  inputHash为输入道路、路口、车辆与预置路径的摘要，
+ *  与当前输入不一致时视为未命中。
+ */
+struct RankCacheHeader {
+	char magic[8];
+	int version;
+	int count;
+	uint64_t inputHash;
+};
+
+class RankCache {
+public:
+	static const int version = 1;
+
+	static bool load(const string& path, uint64_t inputHash, vector<int>& ids);
+	static void save(const string& path, uint64_t inputHash, const vector<int>& ids);
+};
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef __REFRESH_H__
+#define __REFRESH_H__
+
+#include "common.h"
+
+struct Road;
+
+/**
+ *  RoutingRefresh决定本时间片是否需要重新计算floyd路由表。
+ *
+ *  自上次重算起累计各有向道路负载(jam + presetJam) / (length * laneNumber)
+ *  与惩罚值的变化量，超过threshold或已有maxStale个时间片未重算时重算。
+ *  threshold为0时每个时间片都重算，与原先行为一致。
+ *  回滚后路网状态整体改变，总是重算。
+ */
+class RoutingRefresh {
+	vector<double> base;	// 上次重算时每条道路的(正向负载，反向负载，惩罚)
+	int stale;
+
+public:
+	double threshold;
+	int maxStale;
+
+	int rebuilds;
+	int skipped;
+	double maxDrift;		// 跳过重算时的最大累计变化量
+
+	RoutingRefresh(): stale(0), threshold(0), maxStale(10), rebuilds(0), skipped(0), maxDrift(0) {}
+
+	bool due(const vector<Road>& roads, bool force);
+	void report() const;
+};
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef __ROUTE_H__
+#define __ROUTE_H__
+
+#include "common.h"
+
+/**
+ *  RoutePool为所有车辆路径的统一存储池。
+ *
+ *  每辆车在data中占有一段连续区间(begin, size, cap)，
+ *  追加超出容量时将该段整体搬到池尾并扩容一倍，
+ *  原区间成为碎片，由compact()统一回收。
+ *  保存现场只需拷贝data与spans两个连续数组。
+ */
+struct RouteSpan {
+	int begin;
+	int size;
+	int cap;
+
+	RouteSpan(): begin(0), size(0), cap(0) {}
+};
+
+class RoutePool {
+	vector<int> data;
+	vector<RouteSpan> spans;
+	int live;	// 所有区间容量之和，其余为碎片
+
+	void grow(int idx);
+
+public:
+	RoutePool(): live(0) {}
+
+	void init(size_t carNum) {
+		data.clear();
+		spans.assign(carNum, RouteSpan());
+		live = 0;
+	}
+
+	int size(int idx) const {
+		return spans[idx].size;
+	}
+
+	bool empty(int idx) const {
+		return spans[idx].size == 0;
+	}
+
+	int at(int idx, int i) const {
+		assert(i >= 0 and i < spans[idx].size);
+		return data[spans[idx].begin + i];
+	}
+
+	int back(int idx) const {
+		assert(spans[idx].size > 0);
+		return data[spans[idx].begin + spans[idx].size - 1];
+	}
+
+	const int* begin(int idx) const {
+		return data.data() + spans[idx].begin;
+	}
+
+	const int* end(int idx) const {
+		return data.data() + spans[idx].begin + spans[idx].size;
+	}
+
+	void push(int idx, int roadId) {
+		if (spans[idx].size == spans[idx].cap)
+			grow(idx);
+		data[spans[idx].begin + spans[idx].size++] = roadId;
+	}
+
+	/*
+	 * 仅截断长度，保留容量供之后重新决策时复用
+	 */
+	void clear(int idx) {
+		spans[idx].size = 0;
+	}
+
+	/*
+	 * 保留前n条道路，用于从当前道路之后重新规划
+	 */
+	void truncate(int idx, int n) {
+		assert(n >= 0 and n <= spans[idx].size);
+		spans[idx].size = n;
+	}
+
+	void assign(int idx, const vector<int>& route);
+
+	/*
+	 * 去除搬迁留下的碎片，按车辆序号重新紧凑排列
+	 */
+	void compact();
+	bool fragmented() const {
+		return (int)data.size() > 2 * live;
+	}
+
+	size_t bytes() const {
+		return data.capacity() * sizeof(int) + spans.capacity() * sizeof(RouteSpan);
+	}
+};
+
+/*
+ * RouteRef为单辆车路径的轻量视图，
+ * 接口与原先vector<int> route保持一致。
+ */
+class RouteRef {
+	RoutePool& pool;
+	int idx;
+
+public:
+	RouteRef(RoutePool& p, int i): pool(p), idx(i) {}
+
+	int size() const { return pool.size(idx); }
+	bool empty() const { return pool.empty(idx); }
+	int back() const { return pool.back(idx); }
+	int operator[](int i) const { return pool.at(idx, i); }
+	const int* begin() const { return pool.begin(idx); }
+	const int* end() const { return pool.end(idx); }
+
+	void emplace_back(int roadId) { pool.push(idx, roadId); }
+	void clear() { pool.clear(idx); }
+	void truncate(int n) { pool.truncate(idx, n); }
+	RouteRef& operator=(const vector<int>& route) {
+		pool.assign(idx, route);
+		return *this;
+	}
+};
+
+#endif
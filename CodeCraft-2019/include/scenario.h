@@ -0,0 +1,37 @@
+#ifndef __SCENARIO_H__
+#define __SCENARIO_H__
+
+#include "common.h"
+
+class Scheduler;
+
+/**
+ *  预编译场景文件格式，全部字段为32位整数：
+ *  	ScenarioHeader
+ *  	roads		roadNum * 7		(id，长度，限速，车道数，起点id，终点id，是否双向)，按id升序
+ *  	crosses		crossNum * 8	(id，四条道路id，x，y，是否边界)，按id升序
+ *  	cars		carNum * 8		(id，起点，终点，速度，计划时间，优先，预置，出发时间)，已排序
+ *  	routeEnds	carNum			每辆车预置路径在routeData中的结束位置
+ *  	routeData	routeDataNum	预置路径道路id
+ *
+ *  载入时直接映射文件，不再解析文本、排序车辆或计算路口坐标。
+ */
+struct ScenarioHeader {
+	char magic[8];
+	int version;
+	int roadNum;
+	int crossNum;
+	int carNum;
+	int routeDataNum;
+	int totalCapacity;
+};
+
+class Scenario {
+public:
+	static const int version = 2;
+
+	static void save(Scheduler&, const string& path);
+	static void load(Scheduler&, const string& path);
+};
+
+#endif
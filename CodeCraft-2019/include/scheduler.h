@@ -4,6 +4,18 @@
 #include "common.h"
 #include "graph.h"
 #include "car.h"
+#include "deadlock.h"
+#include "lookahead.h"
+#include "answer.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "profiler.h"
+#include "digest.h"
+#include "memstat.h"
+#include "refresh.h"
+#include "departure.h"
+#include "forecast.h"
+#include "planner.h"
 
 class Scheduler;
 
@@ -19,14 +31,14 @@ struct RoadSimulator {
 
     int getForwardJamDegree();
     int getBackwardJamDegree();
-    int getForwardPresetJamDegree(Scheduler*);
-    int getBackwardPresetJamDegree(Scheduler*);
+    int getForwardPresetJamDegree();
+    int getBackwardPresetJamDegree();
 };
 
 struct FieldInfo {
 	// car info
 	vector<CarState> infoInstantStates;
-	vector<vector<int>> carRoutes;
+	RoutePool infoRoutes;
 	// network
 	vector<RoadSimulator> infoNetwork;
 	// not end car idxs
@@ -46,7 +58,7 @@ struct FieldInfo {
 
 class Scheduler {
 public:
-    unordered_map<int, int> carIdxes;
+    IdIndex carIdxes;
     vector<Car> cars;
     vector<int> garageCarList; // idx
     int garageSize;
@@ -56,6 +68,7 @@ public:
 
     vector<vector<double>> dist;
     vector<vector<int>> next;
+    int nextVersion;					// 每次重建next加一
 
     int home, way, end;
     int presetWay, priorWay;
@@ -73,13 +86,50 @@ public:
 	int stride;
 
 	bool onlyPreset;
+	bool replay;				// 按答案固定路径与出发时间复现
+	string presetCachePath;		// 非空时缓存预置车辆排序
+
+	WaitForGraph waitGraph;
+	bool deadCycle;				// 建立等待图，发现死锁环即停止调度，并只惩罚环上道路
+	vector<int> deadRoads;		// 最近一次死锁环上的道路idx
+	vector<int> deadCrosses;	// 最近一次死锁环上的路口idx
+
+	Lookahead lookahead;
+
+	RoutingRefresh refresh;		// 按道路负载变化决定是否重算floyd
+
+	DepartureController departure;	// 开启后按区域容量放车，替代goCarSize
+
+	JamForecast forecast;		// horizon大于0时按预测车辆数计算道路权重
+	RoutePlanner planner;		// k大于0时非优先车辆出发时规划完整路径
+
+	AnswerWriter* answerWriter;	// 非空时到达终点的车辆即时写出
+	int committedInfo;			// 回滚不早于fieldInfoList中该存档
+
+	Telemetry telemetry;
+
+	TraceWriter trace;
+	bool traceStatus;			// 每个时间片写出road_log.txt
+	bool traceLog;				// 死锁时输出所有等待车辆
+
+	Profiler profiler;			// 编译时定义PROFILE才统计
+
+	StateDigest digest;			// 每个时间片的状态摘要
+
+	MemoryStats memory;			// 存档时采样各数据结构的内存占用
 
 public:
     
     friend class Graph;
-    Scheduler(ifstream&, ifstream&, ifstream&, ifstream&);
-    void outputAnswer(ofstream&);
+    Scheduler(const string&, const string&, const string&, const string&);
+    explicit Scheduler(const string&);
+    void initParams();
+    void indexCars();
+    void outputAnswer(AnswerWriter&);
+    void commitAnswer(int time);
     void simulate();
+    bool judge();
+    void outputScore();
 
     void initNetwork();
 
@@ -94,15 +144,17 @@ public:
     void updateRoadCars(vector<deque<int>>& road, int raodIdx, int laneIdx);
     
     bool decide(int carIdx);
+    bool decidePlanned(int carIdx);
     bool readyToGo(int carIdx);
 
-    void updateCrossCars(Cross& cross);
+    void updateCrossCars(int crossIdx);
     bool getCarFromSequeue(const vector<deque<int>>& lanes, int& CarIdx);
-    bool conflict(int carIdx, int direction, const Cross& cross);
-    vector<deque<int>>* inOutLanes(int roadIdx, int crossId, bool in);
+    bool conflict(int carIdx, int direction, int crossIdx);
+    int conflictDir(int carIdx, int direction, int crossIdx);
+    vector<deque<int>>* inOutLanes(int roadIdx, int crossIdx, bool in);
 
-    bool conflict(int carIdx, int direction, int otherDir, const Cross& cross);
-    bool moveToNextRoad(int carIdx, int nowRoadIdx, int crossId, deque<int>& nowLane);
+    bool conflict(int carIdx, int direction, int otherDir, int crossIdx);
+    bool moveToNextRoad(int carIdx, int nowRoadIdx, int crossIdx, deque<int>& nowLane);
     bool getChannel(const vector<deque<int>>& lanes, int& channel);
     void driveCarInitList(bool priority);
     void runCarInInitList(int roadIdx, bool priority, bool forward);
@@ -118,7 +170,7 @@ public:
 	void outputLog();
 
     void updateRoads(int);
-    void readAnswer(ifstream& answerIn);
+    bool readAnswer(const string& answerPath);
     int getCarIdx(int id);
 
     void computeFactor();
@@ -133,7 +185,12 @@ public:
 	int getRoadAfterNowRoadIdx(int);
 
 	void updatePenalty();
+	void reportDeadCycle();
+	void recordTick(int phase, int step, int event);
+	uint64_t stateDigest();
+	vector<int> rankPresetCars();
 	void changeTenPercent();
+	uint64_t inputDigest();
 };
 
 #endif
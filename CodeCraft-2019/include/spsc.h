@@ -0,0 +1,54 @@
+#ifndef __SPSC_H__
+#define __SPSC_H__
+
+#include "common.h"
+#include <atomic>
+
+/**
+ *  单生产者单消费者无锁环形队列，
+ *  容量为2的幂，head只由消费者写，tail只由生产者写。
+ */
+template<class T>
+class SpscQueue {
+	vector<T> buffer;
+	size_t mask;
+	// head与tail分处不同缓存行，避免生产者与消费者伪共享
+	char padHead[64];
+	atomic<size_t> head;
+	char padTail[64 - sizeof(atomic<size_t>)];
+	atomic<size_t> tail;
+	char padEnd[64 - sizeof(atomic<size_t>)];
+
+public:
+	explicit SpscQueue(size_t capacity): head(0), tail(0) {
+		size_t n = 1;
+		while (n < capacity)
+			n <<= 1;
+		buffer.resize(n);
+		mask = n - 1;
+	}
+
+	bool push(const T& value) {
+		size_t t = tail.load(memory_order_relaxed);
+		if (t - head.load(memory_order_acquire) == buffer.size())
+			return false;
+		buffer[t & mask] = value;
+		tail.store(t + 1, memory_order_release);
+		return true;
+	}
+
+	bool pop(T& value) {
+		size_t h = head.load(memory_order_relaxed);
+		if (h == tail.load(memory_order_acquire))
+			return false;
+		value = buffer[h & mask];
+		head.store(h + 1, memory_order_release);
+		return true;
+	}
+
+	bool empty() const {
+		return head.load(memory_order_acquire) == tail.load(memory_order_acquire);
+	}
+};
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef __TELEMETRY_H__
+#define __TELEMETRY_H__
+
+#include "common.h"
+
+enum TickEvent {TICK_NORMAL, TICK_DEAD_BLOCK};
+
+/*
+ * 单个时间片结束时的统计，phase为0表示只跑预置车辆的预演
+ */
+struct TickRecord {
+	int phase;
+	int time;
+	int home, way, end;
+	int priorWay, presetWay;
+	int waiting;
+	int goCarSize;
+	int step;
+	int event;
+	int cycleLength;
+};
+
+/*
+ * 死锁回滚事件，记录环上道路id
+ */
+struct RollbackEvent {
+	int time;
+	int step;
+	vector<int> roads;
+	vector<int> crosses;
+};
+
+/**
+ *  Telemetry将每个时间片的统计写入预先分配的环形缓冲区，
+ *  满后覆盖最早的记录，运行结束或需要时一次性导出。
+ *  默认关闭，关闭时record不做任何事。
+ */
+class Telemetry {
+	vector<TickRecord> ring;
+	size_t head;		// 下一条写入位置
+	size_t count;
+	vector<RollbackEvent> rollbacks;
+
+public:
+	Telemetry(): head(0), count(0) {}
+
+	bool enabled() const {
+		return not ring.empty();
+	}
+
+	void enable(size_t capacity) {
+		ring.assign(capacity, TickRecord());
+		head = count = 0;
+	}
+
+	void record(const TickRecord& r) {
+		if (ring.empty())
+			return;
+		ring[head] = r;
+		head = (head + 1) % ring.size();
+		count = min(count + 1, ring.size());
+	}
+
+	void recordRollback(const RollbackEvent& e) {
+		if (not ring.empty())
+			rollbacks.emplace_back(e);
+	}
+
+	size_t size() const {
+		return count;
+	}
+
+	/*
+	 * 第i条记录，0为缓冲区中最早的一条
+	 */
+	const TickRecord& at(size_t i) const {
+		return ring[(head + ring.size() - count + i) % ring.size()];
+	}
+
+	void dump(const string& path) const;
+	void dumpCsv(const string& path) const;
+	void dumpBinary(const string& path) const;
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include "common.h"
+#include "spsc.h"
+#include <thread>
+
+enum TraceType {
+	STATUS_LANE,		// (道路id，时间，车道序号)
+	STATUS_CAR,			// (离路口距离，车辆id)
+	STATUS_LANE_END,
+	LOG_TICK,			// (时间)
+	LOG_ROAD,			// (道路id，起点，终点，车道数，限速，长度)
+	LOG_DIRECTION,		// (是否正向)
+	LOG_LANE,			// (车道序号)
+	LOG_CAR,			// (车辆id，位置，速度，出发时间，起点，终点，是否预置)
+	LOG_ROAD_END,
+	LOG_TICK_END
+};
+
+/*
+ * 定长紧凑记录，由后台线程格式化
+ */
+struct TraceRecord {
+	int type;
+	int v[7];
+};
+
+/**
+ *  TraceWriter在后台线程上写出road_log.txt与等待车辆日志。
+ *  调度线程只把TraceRecord放入无锁队列，
+ *  队列满时让出CPU等待，不丢记录。
+ *  首次写入时启动线程，close()写完剩余记录后退出。
+ */
+class TraceWriter {
+	SpscQueue<TraceRecord> queue;
+	thread worker;
+	atomic<bool> stopping;
+	FILE* statusFile;
+
+	void loop();
+	void handle(const TraceRecord&);
+
+public:
+	TraceWriter(): queue(1 << 16), stopping(false), statusFile(nullptr) {}
+	~TraceWriter() {
+		close();
+	}
+
+	void push(int type, int v0 = 0, int v1 = 0, int v2 = 0, int v3 = 0, int v4 = 0, int v5 = 0, int v6 = 0) {
+		if (not worker.joinable())
+			worker = thread(&TraceWriter::loop, this);
+		TraceRecord r = {type, {v0, v1, v2, v3, v4, v5, v6}};
+		while (not queue.push(r))
+			this_thread::yield();
+	}
+
+	void close();
+};
+
+#endif
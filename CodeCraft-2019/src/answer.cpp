@@ -0,0 +1,122 @@
+#include "answer.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+/*
+ * 两位数字查找表，每次处理两位
+ */
+static const char digitPairs[201] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+static char* formatInt(char* p, int value) {
+	unsigned int v = (unsigned int)value;
+	if (value < 0) {
+		*p++ = '-';
+		v = 0u - v;
+	}
+	char tmp[12];
+	char* q = tmp + sizeof(tmp);
+	while (v >= 100) {
+		unsigned int r = (v % 100) * 2;
+		v /= 100;
+		*--q = digitPairs[r + 1];
+		*--q = digitPairs[r];
+	}
+	if (v >= 10) {
+		*--q = digitPairs[v * 2 + 1];
+		*--q = digitPairs[v * 2];
+	} else {
+		*--q = (char)('0' + v);
+	}
+	size_t n = tmp + sizeof(tmp) - q;
+	memcpy(p, q, n);
+	return p + n;
+}
+
+AnswerWriter::AnswerWriter(const string& path): buffer(1 << 20), used(0), streaming(false), maxRollback(8) {
+	fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		cout << "fail to read answerPath" << endl;
+		assert(false);
+	}
+}
+
+AnswerWriter::~AnswerWriter() {
+	flush();
+	if (fd >= 0)
+		close(fd);
+}
+
+void AnswerWriter::flush() {
+	size_t done = 0;
+	while (done < used) {
+		ssize_t n = write(fd, buffer.data() + done, used - done);
+		if (n <= 0) {
+			cout << "fail to write answer" << endl;
+			assert(false);
+			break;
+		}
+		done += (size_t)n;
+	}
+	used = 0;
+}
+
+void AnswerWriter::writeHeader() {
+	static const char header[] = "#(carId,StartTime,RoadId...)\n";
+	reserve(sizeof(header));
+	memcpy(buffer.data() + used, header, sizeof(header) - 1);
+	used += sizeof(header) - 1;
+}
+
+void AnswerWriter::writeCar(int id, int startTime, const RouteRef& route) {
+	// 每个整数至多11个字符，加上", "分隔
+	reserve(16 * (route.size() + 2) + 4);
+	char* p = buffer.data() + used;
+	*p++ = '(';
+	p = formatInt(p, id);
+	*p++ = ',';
+	*p++ = ' ';
+	p = formatInt(p, startTime);
+	for (int roadIdx : route) {
+		*p++ = ',';
+		*p++ = ' ';
+		p = formatInt(p, roadIds[roadIdx]);
+	}
+	*p++ = ')';
+	*p++ = '\n';
+	used = p - buffer.data();
+}
+
+/*
+ * 回滚到time时刻，丢弃此后到达的记录
+ */
+void AnswerWriter::rollback(int time) {
+	pending.erase(remove_if(pending.begin(), pending.end(), [time](const pair<int, int>& p)->bool {
+		return p.first >= time;
+	}), pending.end());
+}
+
+/*
+ * 取出到达时间早于time的记录，按到达顺序返回车辆idx
+ */
+vector<int> AnswerWriter::commit(int time) {
+	vector<int> carIdxs;
+	int kept = 0;
+	for (auto& p : pending) {
+		if (p.first < time)
+			carIdxs.emplace_back(p.second);
+		else
+			pending[kept++] = p;
+	}
+	pending.resize(kept);
+	return carIdxs;
+}
@@ -0,0 +1,42 @@
+#include "deadlock.h"
+
+void WaitForGraph::reset(int nodeNum) {
+	waitFor.assign(nodeNum, -1);
+	waitEpoch.assign(nodeNum, 0);
+	epoch.assign(nodeNum, 0);
+	cycle.clear();
+}
+
+void WaitForGraph::progress(int node) {
+	waitFor[node] = -1;
+	++epoch[node];
+}
+
+/*
+ * 记录node被blocker阻挡，
+ * 若由此形成有效等待环则写入cycle并返回true
+ */
+bool WaitForGraph::block(int node, int blocker) {
+	waitFor[node] = blocker;
+	waitEpoch[node] = epoch[blocker];
+
+	int cur = node;
+	for (int steps = 0; steps < (int)waitFor.size(); ++steps) {
+		int next = waitFor[cur];
+		if (next == -1 or waitEpoch[cur] != epoch[next])
+			return false;
+		if (next == node)
+			break;
+		cur = next;
+	}
+	if (waitFor[cur] != node)
+		return false;
+
+	cycle.clear();
+	cur = node;
+	do {
+		cycle.emplace_back(cur);
+		cur = waitFor[cur];
+	} while (cur != node);
+	return true;
+}
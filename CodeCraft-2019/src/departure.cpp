@@ -0,0 +1,93 @@
+#include "departure.h"
+#include "scheduler.h"
+
+void DepartureController::init(const Scheduler& s) {
+	const Graph& graph = s.graph;
+	int minX = INF, minY = INF, maxX = -INF, maxY = -INF;
+	for (const Cross& cross : graph.crosses) {
+		minX = min(minX, cross.x);
+		minY = min(minY, cross.y);
+		maxX = max(maxX, cross.x);
+		maxY = max(maxY, cross.y);
+	}
+	int size = max(1, regionSize);
+	int cols = (maxX - minX) / size + 1;
+	int rows = (maxY - minY) / size + 1;
+	crossRegion.resize(graph.crosses.size());
+	for (int i = 0; i < (int)graph.crosses.size(); ++i)
+		crossRegion[i] = (graph.crosses[i].y - minY) / size * cols + (graph.crosses[i].x - minX) / size;
+
+	capacity.assign(rows * cols, 0);
+	nodeRegion.assign(2 * graph.roads.size(), -1);
+	totalCapacity = graph.totalCapacity;
+	for (int i = 0; i < (int)graph.roads.size(); ++i) {
+		const Road& road = graph.roads[i];
+		int lanes = road.length * road.laneNumber;
+		nodeRegion[2 * i] = crossRegion[road.from];
+		capacity[nodeRegion[2 * i]] += lanes;
+		if (road.duplex) {
+			nodeRegion[2 * i + 1] = crossRegion[road.to];
+			capacity[nodeRegion[2 * i + 1]] += lanes;
+		}
+	}
+	occupancy.assign(capacity.size(), 0);
+	open.assign(capacity.size(), true);
+	scale = 1;
+}
+
+/*
+ * 统计各区域车辆并更新开放状态，
+ * 已决定出发但尚未上路的车辆计入出发路口所在区域
+ */
+void DepartureController::begin(const Scheduler& s) {
+	fill(occupancy.begin(), occupancy.end(), 0);
+	for (int i = 0; i < (int)s.network.size(); ++i) {
+		const RoadSimulator& road = s.network[i];
+		for (const deque<int>& lane : road.forward)
+			occupancy[nodeRegion[2 * i]] += (int)lane.size();
+		for (const deque<int>& lane : road.backward)
+			occupancy[nodeRegion[2 * i + 1]] += (int)lane.size();
+	}
+	for (int carIdx : s.canGoCar) {
+		if (Car::instantStates[carIdx].location == HOME)
+			++occupancy[crossRegion[s.cars[carIdx].src]];
+	}
+	for (int r = 0; r < (int)capacity.size(); ++r) {
+		if (occupancy[r] < lowWater * scale * capacity[r])
+			open[r] = true;
+		else if (occupancy[r] >= highWater * scale * capacity[r])
+			open[r] = false;
+	}
+	budget = (int)(globalLoad * scale * totalCapacity) - (int)s.canGoCar.size();
+}
+
+/*
+ * 优先车辆不受区域开放状态限制，但仍受区域与全网上限约束
+ */
+bool DepartureController::admit(int srcCrossIdx, bool prior) {
+	int r = crossRegion[srcCrossIdx];
+	if (budget <= 0 or (not open[r] and not prior) or occupancy[r] >= highWater * scale * capacity[r]) {
+		++denied;
+		return false;
+	}
+	++occupancy[r];
+	--budget;
+	++released;
+	return true;
+}
+
+void DepartureController::onDeadBlock() {
+	scale = max(0.5, scale * 0.9);
+	++deadBlocks;
+}
+
+void DepartureController::onTick() {
+	scale = min(1.0, scale + 0.002);
+}
+
+void DepartureController::report() const {
+	if (not enabled)
+		return;
+	cout << "Departure: " << capacity.size() << " regions, " << released << " released, " << denied
+		<< " denied, " << deadBlocks << " dead blocks, final scale " << scale << endl;
+}
@@ -0,0 +1,65 @@
+#include "digest.h"
+
+/*
+ * outPath与referencePath均可为空，分别表示不写出、不比较
+ */
+void StateDigest::open(const string& outPath, const string& referencePath) {
+	close();
+	seq = 0;
+	reference.clear();
+	if (not outPath.empty()) {
+		out = fopen(outPath.c_str(), "w");
+		if (out == nullptr) {
+			cout << "fail to write " << outPath << endl;
+			assert(false);
+			return;
+		}
+	}
+	if (not referencePath.empty()) {
+		FILE* in = fopen(referencePath.c_str(), "r");
+		if (in == nullptr) {
+			cout << "fail to read " << referencePath << endl;
+			assert(false);
+			return;
+		}
+		int i;
+		DigestEntry e;
+		unsigned long long hash;
+		while (fscanf(in, "%d %d %d %llx", &i, &e.phase, &e.time, &hash) == 4) {
+			e.hash = hash;
+			reference.emplace_back(e);
+		}
+		fclose(in);
+	}
+	on = true;
+}
+
+/*
+ * 与参考记录不一致时输出该时间片并返回false，
+ * 参考记录已用完时不再比较
+ */
+bool StateDigest::check(int phase, int time, uint64_t hash) {
+	if (out != nullptr)
+		fprintf(out, "%d %d %d %016llx\n", seq, phase, time, (unsigned long long)hash);
+	bool ok = true;
+	if (seq < (int)reference.size()) {
+		const DigestEntry& e = reference[seq];
+		if (e.phase != phase or e.time != time or e.hash != hash) {
+			printf("digest diverges at #%d: phase %d time %d hash %016llx, reference phase %d time %d hash %016llx\n",
+				seq, phase, time, (unsigned long long)hash, e.phase, e.time, (unsigned long long)e.hash);
+			ok = false;
+		}
+	} else if (seq == (int)reference.size() and not reference.empty()) {
+		printf("digest: reference ends at #%d\n", seq);
+	}
+	++seq;
+	return ok;
+}
+
+void StateDigest::close() {
+	if (out != nullptr) {
+		fclose(out);
+		out = nullptr;
+	}
+	on = false;
+}
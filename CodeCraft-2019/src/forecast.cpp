@@ -0,0 +1,88 @@
+#include "forecast.h"
+#include "scheduler.h"
+
+void JamForecast::init(const Scheduler& s) {
+	const Graph& graph = s.graph;
+	crossNum = (int)graph.crosses.size();
+	roads.resize(graph.roads.size());
+	roadBetween.assign(crossNum * crossNum, -1);
+	for (int i = 0; i < (int)graph.roads.size(); ++i) {
+		const Road& road = graph.roads[i];
+		roads[i].length = road.length;
+		roads[i].speed = road.speedLimit;
+		roads[i].from = road.from;
+		roads[i].to = road.to;
+		roadBetween[roads[i].from * crossNum + roads[i].to] = i;
+		if (road.duplex)
+			roadBetween[roads[i].to * crossNum + roads[i].from] = i;
+	}
+	carDest.resize(s.cars.size());
+	for (int i = 0; i < (int)s.cars.size(); ++i)
+		carDest[i] = s.cars[i].dest;
+	load.assign(2 * roads.size() * (horizon + 1), 0);
+}
+
+/*
+ * 从t时刻起车辆位于有向道路node上，距离驶出还有remain，
+ * routePos为路径中node之后一条道路的位置
+ */
+void JamForecast::project(const Scheduler& s, int carIdx, int node, int remain, int routePos, int t) {
+	int maxSpeed = Car::getMaxSpeed(carIdx);
+	int dest = carDest[carIdx];
+	RouteRef route = Car::getRoute(carIdx);
+	while (t <= horizon) {
+		const RoadInfo& road = roads[node / 2];
+		int speed = min(road.speed, maxSpeed);
+		int stay = max(1, (remain + speed - 1) / speed);
+		int* p = &load[node * (horizon + 1)];
+		for (int h = t; h < t + stay and h <= horizon; ++h)
+			++p[h];
+		t += stay;
+
+		int cross = node % 2 == 0 ? road.to : road.from;
+		if (cross == dest or t > horizon)
+			return;
+		int roadIdx = -1;
+		if (routePos < route.size()) {
+			roadIdx = route[routePos++];
+		} else {
+			if (s.next.empty() or s.next[cross][dest] == -1)
+				return;
+			roadIdx = roadBetween[cross * crossNum + s.next[cross][dest]];
+		}
+		if (roadIdx == -1)
+			return;
+		node = roadIdx * 2 + (roads[roadIdx].from == cross ? 0 : 1);
+		remain = roads[roadIdx].length;
+	}
+}
+
+void JamForecast::build(const Scheduler& s) {
+	fill(load.begin(), load.end(), 0);
+	for (int i = 0; i < (int)s.network.size(); ++i) {
+		const RoadSimulator& road = s.network[i];
+		for (int dir = 0; dir < 2; ++dir) {
+			for (const deque<int>& lane : dir == 0 ? road.forward : road.backward) {
+				for (int carIdx : lane) {
+					int remain = roads[i].length - Car::instantStates[carIdx].offset;
+					project(s, carIdx, i * 2 + dir, remain, Car::instantStates[carIdx].nowRoadIdx + 1, 0);
+				}
+			}
+		}
+	}
+
+	/*
+	 * 车库中的车辆：已决定出发但未上路的立即计入，
+	 * 预置车辆按出发时间计入，
+	 * 尚无路径的车辆不知道第一条道路，跳过
+	 */
+	for (int j = 0; j < s.garageSize; ++j) {
+		int carIdx = s.garageCarList[j];
+		const Car& car = s.cars[carIdx];
+		int t = max(0, car.startTime - s.curTime);
+		if (car.startTime == INF or t > horizon or Car::getRoute(carIdx).empty())
+			continue;
+		int roadIdx = Car::getRoute(carIdx)[0];
+		project(s, carIdx, roadIdx * 2 + (roads[roadIdx].from == car.src ? 0 : 1), roads[roadIdx].length, 1, t);
+	}
+}
@@ -1,9 +1,11 @@
 #include "graph.h"
+#include "forecast.h"
 #include "scheduler.h"
+#include "parser.h"
 #include <cmath>
 
 /*
- *  读入roadStream与crossStream文件流中内容
+ *  读入road与cross文件中内容
  *  roads:
  *  	(道路id，道路长度，最高限速，车道数目，起始点id，终点id，是否双向)
  *  crosses:
@@ -12,17 +14,23 @@
  */
 
 
-Graph::Graph(ifstream& roadStream, ifstream& crossStream) {
+Graph::Graph(const string& roadPath, const string& crossPath) {
 	totalCapacity = 0;
-	string str;
-	while (getline(roadStream, str)) {
-		if (str.empty() or str[0] == '#')
+	forecast = nullptr;
+	MappedFile roadFile(roadPath);
+	TupleReader roadReader(roadFile);
+	int v[7];
+	while (roadReader.nextLine()) {
+		if (not roadReader.nextInts(v, 7))
 			continue;
-		int duplex;
 		Road road;
-		sscanf(str.c_str(), "(%d, %d, %d, %d, %d, %d, %d)", &road.id, &road.length, &road.speedLimit,
-			&road.laneNumber, &road.startId, &road.endId, &duplex);
-		road.duplex = (duplex == 1);
+		road.id = v[0];
+		road.length = v[1];
+		road.speedLimit = v[2];
+		road.laneNumber = v[3];
+		road.startId = v[4];
+		road.endId = v[5];
+		road.duplex = (v[6] == 1);
 		road.forJam = road.backJam = road.extraJam = 0;
 		road.penalty = 0;
 		road.keyRoad = false;
@@ -32,25 +40,19 @@ Graph::Graph(ifstream& roadStream, ifstream& crossStream) {
 			totalCapacity += road.length * road.laneNumber;
 		}
 
-		hash.emplace(make_pair(road.startId, road.endId), roads.size());
-		if (road.duplex)
-			hash.emplace(make_pair(road.endId, road.startId), roads.size());
 		roads.emplace_back(road);
 	}
 
 	sort(roads.begin(), roads.end(), [](const Road& r1, const Road& r2)->bool { return r1.id < r2.id; });
-	for (int i = 0; i < (int)roads.size(); ++i)
-		roadIdx.emplace(roads[i].id, i);
 
-	while (getline(crossStream, str)) {
-		if (str.empty() or str[0] == '#')
+	MappedFile crossFile(crossPath);
+	TupleReader crossReader(crossFile);
+	while (crossReader.nextLine()) {
+		if (not crossReader.nextInts(v, 5))
 			continue;
 		Cross cross;
-		int pathes[4];
-		sscanf(str.c_str(), "(%d, %d, %d, %d, %d)", &cross.id, &pathes[0], &pathes[1], &pathes[2], &pathes[3]);
-		for (int i = 0; i < 4; ++i) {
-			cross.roads.emplace_back(pathes[i]);
-		}
+		cross.id = v[0];
+		copy(v + 1, v + 5, cross.roads.begin());
 		cross.waitCarNum = 0;
 		cross.gapNum = 0;
 		crosses.emplace_back(cross);
@@ -58,11 +60,76 @@ Graph::Graph(ifstream& roadStream, ifstream& crossStream) {
 
 	// crosses中所有cross以id升序排列
 	sort(crosses.begin(), crosses.end(), [](const Cross& c1, const Cross& c2)->bool { return c1.id < c2.id; });
-	for (int i = 0; i < (int)crosses.size(); ++i)
-		crossIdx.emplace(crosses[i].id, i);
+	indexRoadsAndCrosses();
 	//setKeyRoad();
 
 	detectEdge();
+	linkCrosses();
+}
+
+/*
+ * 建立道路与路口id到idx的映射，并记录道路两端路口idx，
+ * 要求roads与crosses已按id升序排列
+ */
+void Graph::indexRoadsAndCrosses() {
+	vector<int> ids(roads.size());
+	for (int i = 0; i < (int)roads.size(); ++i)
+		ids[i] = roads[i].id;
+	roadIdx.build(ids);
+	ids.resize(crosses.size());
+	for (int i = 0; i < (int)crosses.size(); ++i)
+		ids[i] = crosses[i].id;
+	crossIdx.build(ids);
+	for (Road& road : roads) {
+		road.from = crossIdx[road.startId];
+		road.to = crossIdx[road.endId];
+	}
+}
+
+/*
+ * 道路idx到id的映射，写出答案时还原路径
+ */
+vector<int> Graph::roadIds() const {
+	vector<int> ids;
+	for (const Road& road : roads)
+		ids.emplace_back(road.id);
+	return ids;
+}
+
+/*
+ * 填写各路口四个方向的道路idx、相邻路口idx与路口类型，要求已知边界路口。
+ * 路口类型：边界路口为2；三岔路口从缺失方向的对面驶入为1，即只能转弯；其余为0
+ */
+void Graph::linkCrosses() {
+	for (Road& road : roads)
+		road.startSlot = road.endSlot = -1;
+	for (Cross& cross : crosses) {
+		int numRoad = 0;
+		for (int i = 0; i < 4; ++i) {
+			cross.roadIdxs[i] = cross.neighbors[i] = -1;
+			int roadId = cross.roads[i];
+			if (roadId == -1)
+				continue;
+			++numRoad;
+			Road& road = roads[cross.roadIdxs[i] = roadIdx[roadId]];
+			if (road.startId == cross.id)
+				road.startSlot = i;
+			if (road.endId == cross.id)
+				road.endSlot = i;
+			if (road.startId == cross.id)
+				cross.neighbors[i] = road.to;
+			else if (road.duplex)
+				cross.neighbors[i] = road.from;
+		}
+		for (int i = 0; i < 4; ++i) {
+			if (cross.edge)
+				cross.kinds[i] = 2;
+			else if (numRoad == 3 and cross.roads[i] != -1 and cross.roads[(i + 2)%4] == -1)
+				cross.kinds[i] = 1;
+			else
+				cross.kinds[i] = 0;
+		}
+	}
 }
 
 void Graph::displayRoads() {
@@ -74,7 +141,6 @@ void Graph::displayRoads() {
 
 void Graph::displayCrosses() {
 	for (Cross &cross : crosses) {
-		assert(not cross.roads.empty());
 		printf("(%d: %d", cross.id, cross.roads[0]);
 		for (int i = 1; i < (int)cross.roads.size(); ++i)
 			printf(", %d", cross.roads[i]);
@@ -83,70 +149,66 @@ void Graph::displayCrosses() {
 }
 
 Road& Graph::getRoadById(int id) {
-	auto it = roadIdx.find(id);
-	assert(it != roadIdx.end());
-	return roads[it->second];
+	return roads[roadIdx[id]];
 }
 
 Cross& Graph::getCrossById(int id) {
-	auto it = crossIdx.find(id);
-	assert(it != crossIdx.end());
-	return crosses[it->second];
+	return crosses[crossIdx[id]];
 }
 
 int Graph::getRoadIdx(int id) {
-	auto it = roadIdx.find(id);
-	assert(it != roadIdx.end());
-	return it->second;
+	return roadIdx[id];
 }
 
 int Graph::getCrossRoadIdx(int crossId1, int crossId2) {
-	auto it = hash.find(make_pair(crossId1, crossId2));
-	assert(it != hash.end());
-	return it->second;
+	return getLinkRoadIdx(crossIdx[crossId1], crossIdx[crossId2]);
+}
+
+/*
+ * 返回从路口crossIdx1驶向相邻路口crossIdx2的道路idx
+ */
+int Graph::getLinkRoadIdx(int crossIdx1, int crossIdx2) {
+	const Cross& cross = crosses[crossIdx1];
+	for (int i = 0; i < 4; ++i) {
+		if (cross.neighbors[i] == crossIdx2)
+			return cross.roadIdxs[i];
+	}
+	assert(false);
+	return -1;
 }
 
 int Graph::getCrossIdx(int id) {
-	auto it = crossIdx.find(id);
-	assert(it != crossIdx.end());
-	return it->second;
+	return crossIdx[id];
 }
 
 
-int Graph::dijkstra(Car& car , int startCrossId, int endCrossId, int blockRoadId) {
-	//cout << car.id << " " << startCrossId << " " << endCrossId << " " << blockRoadId << endl;
-	
+/*
+ * 从路口startCrossIdx出发，不经过blockRoadIdx，
+ * 返回到endCrossIdx最短路的第一条道路idx
+ */
+int Graph::dijkstra(const CarHot& car, int startCrossIdx, int endCrossIdx, int blockRoadIdx) {
 	const int inf = 0x3f3f3f3f;
 	const int size = (int)crosses.size();
 
 	vector<int> prev(size, -1);
 	vector<double> dist(size, inf);
-	vector<bool> used(size, false);
+	vector<char> used(size, false);
+	vector<double> eta(size, 0);	// 预计到达路口的时间片数
 
-	auto it1 = crossIdx.find(startCrossId), it2 = crossIdx.find(endCrossId);
-	assert(it1 != roadIdx.end() and it2 != roadIdx.end());
-	int startCrossIdx = it1->second, endCrossIdx = it2->second;
 	dist[startCrossIdx] = 0;
 	used[startCrossIdx] = true;
-	for (int roadId : crosses[startCrossIdx].roads) {
-		if (roadId == -1 or roadId == blockRoadId)
+	const Cross& start = crosses[startCrossIdx];
+	for (int k = 0; k < 4; ++k) {
+		int idx = start.neighbors[k];
+		if (idx == -1 or start.roadIdxs[k] == blockRoadIdx)
 			continue;
-		auto it = roadIdx.find(roadId);
-		assert(it != roadIdx.end());
-		int rIdx = it->second;
+		int rIdx = start.roadIdxs[k];
 		Road road = roads[rIdx];
-		int idx = crossIdx[road.endId];
-		if (crossIdx[road.startId] != startCrossIdx && road.duplex) {
-			assert(crossIdx[road.endId] == startCrossIdx);
-			idx = crossIdx[road.startId];
-			double weight = getRoadWeight(road, car, false);
-			dist[idx] = weight;
-			prev[idx] = startCrossIdx;
-		} else if (crossIdx[road.startId] == startCrossIdx) {
-			double weight = getRoadWeight(road, car, true);
-			dist[idx] = weight;
-			prev[idx] = startCrossIdx;
-		}
+		applyForecast(road, rIdx, eta[startCrossIdx]);
+		double weight = getRoadWeight(road, car, road.from == startCrossIdx);
+		dist[idx] = weight;
+		prev[idx] = startCrossIdx;
+		eta[idx] = travelTime(road, car);
 	}
 
 	for (int i = 1; i < size; i++) {
@@ -163,35 +225,23 @@ int Graph::dijkstra(Car& car , int startCrossId, int endCrossId, int blockRoadId
 			while (prev[tmpCrossIdx] != startCrossIdx) {
 				tmpCrossIdx = prev[tmpCrossIdx];
 			}
-			auto iter = hash.find(make_pair(crosses[startCrossIdx].id, crosses[tmpCrossIdx].id)); 
-			assert(iter != hash.end());
-	//		cout << crosses[startCrossIdx].id << " " << crosses[tmpCrossIdx].id << roads[iter->second].id << endl;
-			return roads[iter->second].id;
+			return getLinkRoadIdx(startCrossIdx, tmpCrossIdx);
 		}
 		assert(minIdx >= 0);
 		used[minIdx] = true;
-		for (int roadId : crosses[minIdx].roads) {
-			if (roadId == -1)
+		const Cross& cross = crosses[minIdx];
+		for (int k = 0; k < 4; ++k) {
+			int idx = cross.neighbors[k];
+			if (idx == -1)
 				continue;
-			auto it = roadIdx.find(roadId);
-			assert(it != roadIdx.end());
-			int rIdx = it->second;
+			int rIdx = cross.roadIdxs[k];
 			Road road = roads[rIdx];
-			int idx = crossIdx[road.endId];
-			if (crossIdx[road.startId] != minIdx && road.duplex) {
-				assert(crossIdx[road.endId] == minIdx);
-				idx = crossIdx[road.startId];
-				double weight = getRoadWeight(road, car, false);
-				if (dist[idx] > dist[minIdx] + weight) {
-					dist[idx] = dist[minIdx] + weight;
-					prev[idx] = minIdx;
-				}
-			} else if (crossIdx[road.startId] == minIdx) {
-				double weight = getRoadWeight(road, car, true);
-				if (dist[idx] > dist[minIdx] + weight) {
-					dist[idx] = dist[minIdx] + weight;
-					prev[idx] = minIdx;
-				}
+			applyForecast(road, rIdx, eta[minIdx]);
+			double weight = getRoadWeight(road, car, road.from == minIdx);
+			if (dist[idx] > dist[minIdx] + weight) {
+				dist[idx] = dist[minIdx] + weight;
+				prev[idx] = minIdx;
+				eta[idx] = eta[minIdx] + travelTime(road, car);
 			}
 		}
 	}
@@ -202,25 +252,25 @@ int Graph::dijkstra(Car& car , int startCrossId, int endCrossId, int blockRoadId
 	while (prev[tmpCrossIdx] != startCrossIdx) {
 		tmpCrossIdx = prev[tmpCrossIdx];
 	}
-	auto iter = hash.find(make_pair(crosses[startCrossIdx].id, crosses[tmpCrossIdx].id));
-	//if (iter == hash.end()) {
-	//	cout << crosses[startCrossIdx].id << " " << crosses[tmpCrossIdx].id << endl;
-	//}
-	assert(iter != hash.end());
-	return roads[iter->second].id;
+	return getLinkRoadIdx(startCrossIdx, tmpCrossIdx);
 }
 
 pair<vector<vector<double>>, vector<vector<int>>> Graph::floyd() {
 	vector<vector<int>> next(crosses.size(), vector<int>(crosses.size(), -1));
 	vector<vector<double>> dist(crosses.size(), vector<double>(crosses.size(), 0x3f3f3f3f));
-	for (Road &road : roads) {
-		auto it1 = crossIdx.find(road.startId), it2 = crossIdx.find(road.endId);
-		assert(it1 != roadIdx.end() and it2 != roadIdx.end());
-		dist[it1->second][it2->second] = getRoadFloydWeight(road, true);;
-		next[it1->second][it2->second] = it2->second;
+	for (int i = 0; i < (int)roads.size(); ++i) {
+		Road road = roads[i];
+		if (forecast != nullptr) {
+			road.forJam = (int)(forecast->meanJam(i, true) + 0.5);
+			if (road.duplex)
+				road.backJam = (int)(forecast->meanJam(i, false) + 0.5);
+		}
+		int from = road.from, to = road.to;
+		dist[from][to] = getRoadFloydWeight(road, true);
+		next[from][to] = to;
 		if (road.duplex) {
-			dist[it2->second][it1->second] = getRoadFloydWeight(road, false);
-			next[it2->second][it1->second] = it1->second;
+			dist[to][from] = getRoadFloydWeight(road, false);
+			next[to][from] = from;
 		}
 	}
 	for (int k = 0; k < (int)crosses.size(); ++k) {
@@ -250,9 +300,7 @@ void Graph::setKeyRoad() {
 	for (int i = 0; i < (int)next.size(); i++) {
 		for (int j = 0; j < (int)next[i].size(); j++) {
 			int startIdx = i, nextIdx = next[i][j];
-			auto it = hash.find(make_pair(crosses[startIdx].id, crosses[nextIdx].id));
-			assert(it != hash.end());
-			roadOccur[it->second].second++;
+			roadOccur[getLinkRoadIdx(startIdx, nextIdx)].second++;
 		}
 	}
 	sort(roadOccur.begin(), roadOccur.end(), [](const pair<int,int>& c1, const pair<int,int>& c2)->bool { return c1.second > c2.second; });
@@ -263,58 +311,42 @@ void Graph::setKeyRoad() {
 	}
 }
 
-vector<int> Graph::prevToRoute(const vector<int>& prev, int src, int dest) {
-	auto it1 = crossIdx.find(src), it2 = crossIdx.find(dest);
-	assert(it1 != crossIdx.end() and it2 != crossIdx.end());
-	int startIdx = it1->second, endIdx = it2->second;
+vector<int> Graph::prevToRoute(const vector<int>& prev, int startIdx, int endIdx) {
 	vector<int> route;
 	while (endIdx != startIdx) {
 		int prevIdx = prev[endIdx];
-		auto it = hash.find(make_pair(crosses[prevIdx].id, crosses[endIdx].id));
-		assert(it != hash.end());
-		int roadId = roads[it->second].id;
-		route.insert(route.begin(), roadId);
+		route.insert(route.begin(), getLinkRoadIdx(prevIdx, endIdx));
 		endIdx = prevIdx;
 	}
 	return route;
 }
 
-vector<int> Graph::dijkstraForPrior(Car& car) {
+/*
+ * 返回从路口startIdx到endIdx的最短路，为道路idx序列
+ */
+vector<int> Graph::dijkstraForPrior(const CarHot& car, int startIdx, int endIdx) {
 	const int inf = 0x3f3f3f3f;
 	const int size = crosses.size();
-	const int startId = car.src, endId = car.dest;
 
 	vector<int> prev(size, -1);
 	vector<double> dist(size, inf);
-	vector<bool> used(size, false);
-
-	auto it1 = crossIdx.find(startId);
-	assert(it1 != roadIdx.end());
-	int startIdx = it1->second;
-	auto it2 = crossIdx.find(endId);
-	assert(it2 != roadIdx.end());
-	int endIdx = it2->second;
+	vector<char> used(size, false);
+	vector<double> eta(size, 0);	// 预计到达路口的时间片数
+
 	dist[startIdx] = 0;
 	used[startIdx] = true;
-	for (int roadId : crosses[startIdx].roads) {
-		if (roadId == -1)
+	const Cross& start = crosses[startIdx];
+	for (int k = 0; k < 4; ++k) {
+		int idx = start.neighbors[k];
+		if (idx == -1)
 			continue;
-		auto it = roadIdx.find(roadId);
-		assert(it != roadIdx.end());
-		int rIdx = it->second;
+		int rIdx = start.roadIdxs[k];
 		Road road = roads[rIdx];
-		int idx = crossIdx[road.endId];
-		if (crossIdx[road.startId] != startIdx && road.duplex) {
-			assert(crossIdx[road.endId] == startIdx);
-			idx = crossIdx[road.startId];
-			double weight = getRoadWeight(road, car, false);
-			dist[idx] = weight;
-			prev[idx] = startIdx;
-		} else if (crossIdx[road.startId] == startIdx) {
-			double weight = getRoadWeight(road, car, true);
-			dist[idx] = weight;
-			prev[idx] = startIdx;
-		}
+		applyForecast(road, rIdx, eta[startIdx]);
+		double weight = getRoadWeight(road, car, road.from == startIdx);
+		dist[idx] = weight;
+		prev[idx] = startIdx;
+		eta[idx] = travelTime(road, car);
 	}
 
 	for (int i = 1; i < size; i++) {
@@ -327,85 +359,75 @@ vector<int> Graph::dijkstraForPrior(Car& car) {
 			}
 		}
 		if (minIdx == endIdx) {
-			return prevToRoute(prev, car.src, car.dest);
+			return prevToRoute(prev, startIdx, endIdx);
 		}
 		assert(minIdx >= 0);
 		used[minIdx] = true;
-		for (int roadId : crosses[minIdx].roads) {
-			if (roadId == -1)
+		const Cross& cross = crosses[minIdx];
+		for (int k = 0; k < 4; ++k) {
+			int idx = cross.neighbors[k];
+			if (idx == -1)
 				continue;
-			auto it = roadIdx.find(roadId);
-			assert(it != roadIdx.end());
-			int rIdx = it->second;
+			int rIdx = cross.roadIdxs[k];
 			Road road = roads[rIdx];
-			int idx = crossIdx[road.endId];
-			if (crossIdx[road.startId] != minIdx && road.duplex) {
-				assert(crossIdx[road.endId] == minIdx);
-				idx = crossIdx[road.startId];
-				double weight = getRoadWeight(road, car, false);
-				if (dist[idx] > dist[minIdx] + weight) {
-					dist[idx] = dist[minIdx] + weight;
-					prev[idx] = minIdx;
-				}
-			} else if (crossIdx[road.startId] == minIdx) {
-				double weight = getRoadWeight(road, car, true);
-				if (dist[idx] > dist[minIdx] + weight) {
-					dist[idx] = dist[minIdx] + weight;
-					prev[idx] = minIdx;
-				}
+			applyForecast(road, rIdx, eta[minIdx]);
+			double weight = getRoadWeight(road, car, road.from == minIdx);
+			if (dist[idx] > dist[minIdx] + weight) {
+				dist[idx] = dist[minIdx] + weight;
+				prev[idx] = minIdx;
+				eta[idx] = eta[minIdx] + travelTime(road, car);
 			}
 		}
 	}
 	for (int i = 0; i < size; i++) {
 		assert(used[i]);
 	}
-	return prevToRoute(prev, car.src, car.dest);
+	return prevToRoute(prev, startIdx, endIdx);
 }
 
-bool Graph::isRoadCongested(int roadId, int curCrossIdx) {
-	return getRoadById(roadId).penalty > 15;
-	Road road = roads[roadIdx[roadId]];
-	bool isForward = (crosses[curCrossIdx].id == road.startId);
+bool Graph::isRoadCongested(int rIdx, int curCrossIdx) {
+	return roads[rIdx].penalty > 15;
+	const Road& road = roads[rIdx];
+	bool isForward = (curCrossIdx == road.from);
 	int jamDegree = isForward ? road.forJam : road.backJam;
 	//cout <<(double)jamDegree / (road.laneNumber * road.length)<<endl; 
 	return ((double)jamDegree / (road.laneNumber * road.length)) > 0.6;
 }
 
-int Graph::getCrossKind(int crossId, int fromRoadId) {
-	int crossIdx = getCrossIdx(crossId);
-	Cross cross = crosses[crossIdx];
-	int numRoad = 0;
-	if (getCrossById(crossId).edge) {
-		return 2;
-	}
-	for (int roadId : cross.roads) {
-		if (roadId != -1) {
-			numRoad++;
-		}
-	}
-	assert(numRoad <= 4);
-	if (numRoad == 3) {
-		int idx = -1;
-		for (int i = 0; i < (int)cross.roads.size(); ++i) {
-			if (cross.roads[i] == fromRoadId) {
-				idx = i;
-				break;
-			}
-		}
-		assert(idx != -1);
-		if (cross.roads[(idx + 2)%4] == -1) {
-			return 1;
-		}
-	}
-	return 0;
+/*
+ * slot为驶入道路在路口中的方向，
+ * 道路未登记在该路口时与原先一致：边界路口为2，其余为0
+ */
+int Graph::getCrossKind(int crossIdx, int slot) {
+	const Cross& cross = crosses[crossIdx];
+	if (slot == -1)
+		return cross.edge ? 2 : 0;
+	return cross.kinds[slot];
+}
+
+/*
+ * 按时间片估计的通过时间，用于推算到达后续道路的时刻
+ */
+double Graph::travelTime(const Road& road, const CarHot& car) {
+	return (double)road.length / min(road.speedLimit, car.maxSpeed);
+}
+
+/*
+ * 开启预测时以车辆预计驶入时刻的车辆数代替当前拥堵度
+ */
+void Graph::applyForecast(Road& road, int rIdx, double eta) {
+	if (forecast == nullptr)
+		return;
+	road.forJam = forecast->jam(rIdx, true, eta);
+	if (road.duplex)
+		road.backJam = forecast->jam(rIdx, false, eta);
 }
 
-double Graph::getRoadWeight(const Road& road, const Car& car, bool forward) {
+double Graph::getRoadWeight(const Road& road, const CarHot& car, bool forward) {
 	double k = 100;
 	double l = road.length, m = road.laneNumber, vm = road.speedLimit, d = forward ? road.forJam : road.backJam;
 	double v = car.maxSpeed;
-	int crossId = forward ? road.endId : road.startId;
-	int crossKind = getCrossKind(crossId, road.id);
+	int crossKind = forward ? getCrossKind(road.to, road.endSlot) : getCrossKind(road.from, road.startSlot);
 	double p = (forward ? road.forPresetJam : road.backPresetJam);
 
 	if (crossKind == 1) {
@@ -438,8 +460,7 @@ double Graph::getRoadFloydWeight(const Road& road, bool forward) {
 	}
 	double k = 100;
 	double l = road.length, m = road.laneNumber, vm = road.speedLimit, d = forward ? road.forJam : road.backJam;
-	int crossId = forward ? road.endId : road.startId;
-	int crossKind = getCrossKind(crossId, road.id);
+	int crossKind = forward ? getCrossKind(road.to, road.endSlot) : getCrossKind(road.from, road.startSlot);
 	double p = (forward ? road.forPresetJam : road.backPresetJam);
 
 	if (crossKind == 1) {
@@ -677,7 +698,7 @@ void Graph::detectEdge() {
 vector<vector<int>> Graph::naiveFloyd() {
 	vector<vector<int>> dist(crosses.size(), vector<int>(crosses.size(), 0x3f3f3f3f));
 	for (Road &road : roads) {
-		int idx1 = getCrossIdx(road.startId), idx2 = getCrossIdx(road.endId);
+		int idx1 = road.from, idx2 = road.to;
 		dist[idx1][idx2] = road.length;
 		if (road.duplex)
 			dist[idx2][idx1] = road.length;
@@ -0,0 +1,224 @@
+#include "lookahead.h"
+#include "scheduler.h"
+
+void Lookahead::init(const Scheduler& s) {
+	const Graph& graph = s.graph;
+	crossNum = (int)graph.crosses.size();
+	roads.resize(graph.roads.size());
+	roadBetween.assign(crossNum * crossNum, -1);
+	for (int i = 0; i < (int)graph.roads.size(); ++i) {
+		const Road& road = graph.roads[i];
+		roads[i].length = road.length;
+		roads[i].lanes = road.laneNumber;
+		roads[i].speed = road.speedLimit;
+		roads[i].from = road.from;
+		roads[i].to = road.to;
+		roadBetween[roads[i].from * crossNum + roads[i].to] = i;
+		if (road.duplex)
+			roadBetween[roads[i].to * crossNum + roads[i].from] = i;
+	}
+}
+
+int Lookahead::capacity(int node) const {
+	const ShadowRoad& road = roads[WaitForGraph::roadOf(node)];
+	return road.length * road.lanes;
+}
+
+/*
+ * 返回车辆驶出node后进入的有向道路，
+ * 到达终点返回-1
+ */
+int Lookahead::nextNode(const Snapshot& snap, const ShadowCar& car, int node) const {
+	const ShadowRoad& road = roads[WaitForGraph::roadOf(node)];
+	int cur = WaitForGraph::forwardOf(node) ? road.to : road.from;
+	if (cur == car.dest)
+		return -1;
+	int roadIdx = -1;
+	if (car.routePos != -1 and car.routePos < car.routeEnd) {
+		roadIdx = snap.routeData[car.routePos];
+	} else {
+		int nextCross = (*snap.next)[cur][car.dest];
+		if (nextCross == -1)
+			return -1;
+		roadIdx = roadBetween[cur * crossNum + nextCross];
+	}
+	if (roadIdx == -1)
+		return -1;
+	return WaitForGraph::node(roadIdx, roads[roadIdx].from == cur);
+}
+
+void Lookahead::start(const Scheduler& s) {
+	Snapshot snap;
+	snap.nodes.resize(2 * roads.size());
+	if (next == nullptr or nextVersion != s.nextVersion) {
+		next = make_shared<const vector<vector<int>>>(s.next);
+		nextVersion = s.nextVersion;
+	}
+	snap.next = next;
+
+	auto shadowCar = [&](int carIdx, int routeFrom)->ShadowCar {
+		const CarHot& hot = Car::getHot(carIdx);
+		ShadowCar c;
+		c.offset = Car::getCarOffset(carIdx);
+		c.speed = hot.maxSpeed;
+		c.dest = s.cars[carIdx].dest;
+		c.routePos = c.routeEnd = -1;
+		c.startTime = 0;
+		if ((hot.preset and not hot.reset) or hot.prior or s.planner.k > 0) {
+			c.routePos = (int)snap.routeData.size();
+			RouteRef route = Car::getRoute(carIdx);
+			for (int i = routeFrom; i < route.size(); ++i)
+				snap.routeData.emplace_back(route[i]);
+			c.routeEnd = (int)snap.routeData.size();
+		}
+		return c;
+	};
+
+	for (int i = 0; i < (int)s.network.size(); ++i) {
+		for (int dir = 0; dir < 2; ++dir) {
+			const vector<deque<int>>& lanes = dir == 0 ? s.network[i].forward : s.network[i].backward;
+			vector<int> carIdxs;
+			for (const deque<int>& lane : lanes)
+				carIdxs.insert(carIdxs.end(), lane.begin(), lane.end());
+			sort(carIdxs.begin(), carIdxs.end(), [](int idx1, int idx2)->bool {
+				return Car::getCarOffset(idx1) > Car::getCarOffset(idx2);
+			});
+			vector<ShadowCar>& node = snap.nodes[WaitForGraph::node(i, dir == 0)];
+			for (int carIdx : carIdxs)
+				node.emplace_back(shadowCar(carIdx, Car::getNowRoadIdx(carIdx) + 1));
+		}
+	}
+
+	/*
+	 * 车库中的车辆：预置车辆按其出发时间出发，
+	 * 其余车辆在当前出发额度内按计划时间出发
+	 */
+	int budget = s.goCarSize - (int)s.canGoCar.size();
+	for (int j = 0; j < s.garageSize; ++j) {
+		int carIdx = s.garageCarList[j];
+		const Car& car = s.cars[carIdx];
+		const CarHot& hot = Car::getHot(carIdx);
+		if (Car::getCarLocation(carIdx) != HOME)
+			continue;
+		int startTime;
+		if (hot.preset and not hot.reset) {
+			startTime = car.startTime;
+		} else {
+			if (budget <= 0 or s.onlyPreset)
+				continue;
+			startTime = max(car.planTime, s.curTime + 1);
+		}
+		if (startTime <= s.curTime or startTime > s.curTime + horizon)
+			continue;
+		ShadowCar c = shadowCar(carIdx, 0);
+		c.offset = 0;
+		c.startTime = startTime - s.curTime;
+		int src = car.src;
+		int roadIdx = -1;
+		if (c.routePos != -1 and c.routePos < c.routeEnd) {
+			roadIdx = snap.routeData[c.routePos++];
+		} else if ((*snap.next)[src][c.dest] != -1) {
+			roadIdx = roadBetween[src * crossNum + (*snap.next)[src][c.dest]];
+		}
+		if (roadIdx == -1)
+			continue;
+		if (not (hot.preset and not hot.reset))
+			--budget;
+		snap.garage.emplace_back(c);
+		snap.garageNode.emplace_back(WaitForGraph::node(roadIdx, roads[roadIdx].from == src));
+	}
+
+	pending = async(launch::async, &Lookahead::run, this, move(snap));
+}
+
+/*
+ * 推演horizon个时间片，返回首次出现死锁环的时间片，没有则返回-1
+ */
+int Lookahead::run(Snapshot snap) const {
+	int nodeNum = (int)snap.nodes.size();
+	vector<int> blocked(nodeNum);
+	vector<int> occupy(nodeNum);
+	vector<pair<int, ShadowCar>> transfers;
+	WaitForGraph waitGraph;
+
+	for (int k = 1; k <= horizon; ++k) {
+		for (int node = 0; node < nodeNum; ++node)
+			occupy[node] = (int)snap.nodes[node].size();
+
+		for (int i = 0; i < (int)snap.garage.size(); ++i) {
+			ShadowCar& car = snap.garage[i];
+			if (car.startTime != k)
+				continue;
+			int node = snap.garageNode[i];
+			if (occupy[node] < capacity(node)) {
+				const ShadowRoad& road = roads[WaitForGraph::roadOf(node)];
+				car.offset = min(car.speed, road.speed);
+				snap.nodes[node].emplace_back(car);
+				++occupy[node];
+			} else {
+				++car.startTime;
+			}
+		}
+
+		transfers.clear();
+		for (int node = 0; node < nodeNum; ++node) {
+			const ShadowRoad& road = roads[WaitForGraph::roadOf(node)];
+			vector<ShadowCar>& cars = snap.nodes[node];
+			blocked[node] = -1;
+			int kept = 0;
+			for (int i = 0; i < (int)cars.size(); ++i) {
+				ShadowCar car = cars[i];
+				int v = min(car.speed, road.speed);
+				if (kept >= road.lanes) {
+					car.offset = min(car.offset + v, cars[kept - road.lanes].offset - 1);
+					cars[kept++] = car;
+					continue;
+				}
+				if (car.offset + v <= road.length) {
+					car.offset += v;
+					cars[kept++] = car;
+					continue;
+				}
+				int next = nextNode(snap, car, node);
+				if (next == -1)
+					continue;
+				if (occupy[next] < capacity(next)) {
+					const ShadowRoad& nextRoad = roads[WaitForGraph::roadOf(next)];
+					int remain = road.length - car.offset;
+					car.offset = max(1, min(car.speed, nextRoad.speed) - remain);
+					if (car.routePos != -1 and car.routePos < car.routeEnd)
+						++car.routePos;
+					++occupy[next];
+					transfers.emplace_back(next, car);
+					continue;
+				}
+				car.offset = road.length;
+				if (blocked[node] == -1)
+					blocked[node] = next;
+				cars[kept++] = car;
+			}
+			cars.resize(kept);
+		}
+		for (auto& transfer : transfers)
+			snap.nodes[transfer.first].emplace_back(transfer.second);
+
+		waitGraph.reset(nodeNum);
+		for (int node = 0; node < nodeNum; ++node) {
+			if (blocked[node] != -1 and waitGraph.block(node, blocked[node]))
+				return k;
+		}
+	}
+	return -1;
+}
+
+/*
+ * 等待后台推演结束，返回预测的死锁时间片
+ */
+int Lookahead::collect() {
+	if (not pending.valid())
+		return -1;
+	int k = pending.get();
+	if (k != -1)
+		++predicted;
+	return k;
+}
@@ -0,0 +1,108 @@
+#include "memstat.h"
+#include "scheduler.h"
+
+static const char* subsystemNames[MEM_SUBSYSTEM_NUM] = {
+	"network", "fieldInfoList", "routing", "routes", "id index", "cars"
+};
+
+template<class T>
+static size_t vectorBytes(const vector<T>& v) {
+	return v.capacity() * sizeof(T);
+}
+
+/*
+ * 红黑树节点为颜色与三个指针，再加按8字节对齐的元素
+ */
+template<class T>
+static size_t treeBytes(size_t n) {
+	return n * (32 + (sizeof(T) + 7) / 8 * 8);
+}
+
+/*
+ * libstdc++的deque按512字节分块，中控数组至少8个指针
+ */
+size_t MemoryStats::dequeBytes(const deque<int>& d) {
+	const size_t perChunk = 512 / sizeof(int);
+	size_t chunks = d.size() / perChunk + 1;
+	return chunks * 512 + max<size_t>(8, chunks + 2) * sizeof(int*);
+}
+
+size_t MemoryStats::networkBytes(const vector<RoadSimulator>& network) {
+	size_t bytes = vectorBytes(network);
+	for (const RoadSimulator& road : network) {
+		bytes += vectorBytes(road.forward) + vectorBytes(road.backward);
+		for (const deque<int>& lane : road.forward)
+			bytes += dequeBytes(lane);
+		for (const deque<int>& lane : road.backward)
+			bytes += dequeBytes(lane);
+		bytes += dequeBytes(road.forWait) + dequeBytes(road.backWait);
+	}
+	return bytes;
+}
+
+void MemoryStats::sample(const Scheduler& s) {
+	if (not on)
+		return;
+	live[MEM_NETWORK] = networkBytes(s.network);
+
+	size_t info = vectorBytes(s.fieldInfoList);
+	for (const FieldInfo& f : s.fieldInfoList) {
+		info += vectorBytes(f.infoInstantStates) + f.infoRoutes.bytes() + networkBytes(f.infoNetwork)
+			+ vectorBytes(f.infoGarageCarList) + treeBytes<int>(f.infoCanGoCar.size());
+	}
+	live[MEM_FIELD_INFO] = info;
+
+	size_t routing = vectorBytes(s.dist) + vectorBytes(s.next);
+	for (const vector<double>& row : s.dist)
+		routing += vectorBytes(row);
+	for (const vector<int>& row : s.next)
+		routing += vectorBytes(row);
+	live[MEM_ROUTING] = routing + s.planner.bytes();
+
+	live[MEM_ROUTES] = Car::routes.bytes();
+
+	live[MEM_HASH] = s.carIdxes.bytes() + s.graph.crossIdx.bytes() + s.graph.roadIdx.bytes();
+
+	live[MEM_CARS] = vectorBytes(s.cars) + vectorBytes(Car::hots) + vectorBytes(Car::states) + vectorBytes(Car::nextRoads)
+		+ vectorBytes(Car::instantStates) + vectorBytes(s.garageCarList) + vectorBytes(s.priorCarIdxs)
+		+ treeBytes<int>(s.canGoCar.size());
+
+	size_t total = 0;
+	for (int i = 0; i < MEM_SUBSYSTEM_NUM; ++i) {
+		peak[i] = max(peak[i], live[i]);
+		total += live[i];
+	}
+	if (total > peakTotal) {
+		peakTotal = total;
+		peakTime = s.curTime;
+	}
+	++samples;
+}
+
+/*
+ * 从/proc/self/status读取以kB为单位的字段，读取失败返回0
+ */
+static size_t procStatusKb(const char* key) {
+	ifstream in("/proc/self/status");
+	string line;
+	size_t len = strlen(key);
+	while (getline(in, line)) {
+		if (line.compare(0, len, key) == 0)
+			return strtoul(line.c_str() + len + 1, nullptr, 10);
+	}
+	return 0;
+}
+
+void MemoryStats::report() const {
+	if (not on)
+		return;
+	size_t total = 0;
+	printf("Memory: %d samples\n", samples);
+	printf("%-16s %12s %12s\n", "subsystem", "live(KiB)", "peak(KiB)");
+	for (int i = 0; i < MEM_SUBSYSTEM_NUM; ++i) {
+		printf("%-16s %12zu %12zu\n", subsystemNames[i], live[i] >> 10, peak[i] >> 10);
+		total += live[i];
+	}
+	printf("%-16s %12zu %12zu (peak at t = %d)\n", "total", total >> 10, peakTotal >> 10, peakTime);
+	printf("process RSS %zu KiB, peak RSS %zu KiB\n", procStatusKb("VmRSS"), procStatusKb("VmHWM"));
+}
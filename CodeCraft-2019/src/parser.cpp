@@ -0,0 +1,57 @@
+#include "parser.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const string& path): fd(-1), data(nullptr), length(0) {
+	fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		cout << "fail to read " << path << endl;
+		assert(false);
+		return;
+	}
+	struct stat st;
+	if (fstat(fd, &st) < 0) {
+		cout << "fail to stat " << path << endl;
+		assert(false);
+		return;
+	}
+	length = (size_t)st.st_size;
+	if (length == 0)
+		return;
+	void* addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (addr == MAP_FAILED) {
+		cout << "fail to map " << path << endl;
+		assert(false);
+		length = 0;
+		return;
+	}
+	madvise(addr, length, MADV_SEQUENTIAL);
+	data = (char*)addr;
+}
+
+MappedFile::~MappedFile() {
+	if (data != nullptr)
+		munmap(data, length);
+	if (fd >= 0)
+		close(fd);
+}
+
+vector<pair<const char*, const char*>> splitLines(const char* begin, const char* end, int n, size_t minBytes) {
+	vector<pair<const char*, const char*>> ranges;
+	if (begin == end)
+		return ranges;
+	size_t step = max(minBytes, (size_t)(end - begin) / n + 1);
+	const char* p = begin;
+	while (p < end) {
+		const char* q = p + min(step, (size_t)(end - p));
+		if (q < end) {
+			const char* eol = (const char*)memchr(q, '\n', end - q);
+			q = eol == nullptr ? end : eol + 1;
+		}
+		ranges.emplace_back(p, q);
+		p = q;
+	}
+	return ranges;
+}
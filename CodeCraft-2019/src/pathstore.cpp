@@ -0,0 +1,223 @@
+#include "pathstore.h"
+#include "graph.h"
+#include "car.h"
+#include <queue>
+#include <functional>
+#include <thread>
+#include <atomic>
+
+void PathStore::init(const Graph& graph) {
+	crossNum = (int)graph.crosses.size();
+	adj.assign(crossNum, vector<Edge>());
+	int nodeNum = 2 * (int)graph.roads.size();
+	nodeFrom.assign(nodeNum, -1);
+	nodeTo.assign(nodeNum, -1);
+	freeTime.assign(nodeNum, INF);
+	nodeCapacity.assign(nodeNum, 1);
+	for (int i = 0; i < (int)graph.roads.size(); ++i) {
+		const Road& road = graph.roads[i];
+		int from = road.from, to = road.to;
+		for (int dir = 0; dir < (road.duplex ? 2 : 1); ++dir) {
+			int node = 2 * i + dir;
+			nodeFrom[node] = dir == 0 ? from : to;
+			nodeTo[node] = dir == 0 ? to : from;
+			freeTime[node] = (double)road.length / road.speedLimit;
+			nodeCapacity[node] = road.length * road.laneNumber;
+			adj[nodeFrom[node]].push_back({node, nodeTo[node]});
+		}
+	}
+}
+
+/*
+ * 堆优化Dijkstra，跳过被禁止的有向道路与路口，
+ * 返回有向道路序列，不可达时返回空
+ */
+vector<int> PathStore::shortest(int src, int dest, const vector<double>& weight,
+	const vector<char>* bannedNode, const vector<char>* bannedCross) const {
+	vector<double> dist(crossNum, INF);
+	vector<int> prev(crossNum, -1);
+	priority_queue<pair<double, int>, vector<pair<double, int>>, greater<pair<double, int>>> heap;
+	dist[src] = 0;
+	heap.emplace(0, src);
+	while (not heap.empty()) {
+		double d = heap.top().first;
+		int u = heap.top().second;
+		heap.pop();
+		if (d > dist[u])
+			continue;
+		if (u == dest)
+			break;
+		for (const Edge& e : adj[u]) {
+			if ((bannedNode != nullptr and (*bannedNode)[e.node]) or (bannedCross != nullptr and (*bannedCross)[e.to]))
+				continue;
+			double nd = d + weight[e.node];
+			if (nd < dist[e.to]) {
+				dist[e.to] = nd;
+				prev[e.to] = e.node;
+				heap.emplace(nd, e.to);
+			}
+		}
+	}
+	vector<int> path;
+	if (src == dest or prev[dest] == -1)
+		return path;
+	for (int u = dest; u != src; u = nodeFrom[prev[u]])
+		path.emplace_back(prev[u]);
+	reverse(path.begin(), path.end());
+	return path;
+}
+
+double PathStore::cost(const vector<int>& path) const {
+	double sum = 0;
+	for (int node : path)
+		sum += freeTime[node];
+	return sum;
+}
+
+vector<vector<int>> PathStore::penaltyPaths(int src, int dest, int k, double diversity) const {
+	vector<vector<int>> found;
+	vector<double> weight = freeTime;
+	for (int attempt = 0; attempt < 2 * k and (int)found.size() < k; ++attempt) {
+		vector<int> path = shortest(src, dest, weight, nullptr, nullptr);
+		if (path.empty())
+			break;
+		if (std::find(found.begin(), found.end(), path) == found.end())
+			found.emplace_back(path);
+		for (int node : path) {
+			int road = node / 2;
+			weight[2 * road] *= 1 + diversity;
+			weight[2 * road + 1] *= 1 + diversity;
+		}
+	}
+	return found;
+}
+
+/*
+ * 第i条路径由前一条路径的前缀加上从其第j个路口出发的偏离路径组成，
+ * 偏离路径不能使用与已有路径相同前缀后的下一道路，也不能经过前缀中的路口
+ */
+vector<vector<int>> PathStore::yenPaths(int src, int dest, int k) const {
+	vector<vector<int>> found;
+	vector<int> first = shortest(src, dest, freeTime, nullptr, nullptr);
+	if (first.empty())
+		return found;
+	found.emplace_back(first);
+
+	vector<pair<double, vector<int>>> pending;
+	vector<char> bannedNode(freeTime.size(), 0), bannedCross(crossNum, 0);
+	while ((int)found.size() < k) {
+		const vector<int> last = found.back();
+		for (int i = 0; i < (int)last.size(); ++i) {
+			int spur = nodeFrom[last[i]];
+			for (const vector<int>& path : found) {
+				if ((int)path.size() > i and equal(last.begin(), last.begin() + i, path.begin()))
+					bannedNode[path[i]] = 1;
+			}
+			for (int j = 0; j < i; ++j)
+				bannedCross[nodeFrom[last[j]]] = 1;
+
+			vector<int> tail = shortest(spur, dest, freeTime, &bannedNode, &bannedCross);
+			if (not tail.empty()) {
+				vector<int> path(last.begin(), last.begin() + i);
+				path.insert(path.end(), tail.begin(), tail.end());
+				bool known = std::find(found.begin(), found.end(), path) != found.end();
+				for (int j = 0; j < (int)pending.size() and not known; ++j)
+					known = pending[j].second == path;
+				if (not known)
+					pending.emplace_back(cost(path), path);
+			}
+
+			for (const vector<int>& path : found) {
+				if ((int)path.size() > i)
+					bannedNode[path[i]] = 0;
+			}
+			for (int j = 0; j < i; ++j)
+				bannedCross[nodeFrom[last[j]]] = 0;
+		}
+		if (pending.empty())
+			break;
+		auto best = min_element(pending.begin(), pending.end());
+		found.emplace_back(best->second);
+		pending.erase(best);
+	}
+	return found;
+}
+
+void PathStore::build(const vector<pair<int, int>>& ods, int k, int threads) {
+	vector<pair<int, int>> todo;
+	for (const pair<int, int>& od : ods) {
+		if (od.first != od.second and find(od.first, od.second).second == -1)
+			todo.emplace_back(od);
+	}
+	sort(todo.begin(), todo.end());
+	todo.erase(unique(todo.begin(), todo.end()), todo.end());
+
+	vector<vector<vector<int>>> results(todo.size());
+	atomic<int> cursor(0);
+	auto work = [&]() {
+		for (int i = cursor++; i < (int)todo.size(); i = cursor++)
+			results[i] = yenPaths(todo[i].first, todo[i].second, k);
+	};
+	int n = threads > 0 ? threads : max(1, (int)thread::hardware_concurrency());
+	n = min(n, (int)todo.size());
+	if (n <= 1) {
+		work();
+	} else {
+		vector<thread> workers;
+		for (int i = 0; i < n; ++i)
+			workers.emplace_back(work);
+		for (thread& worker : workers)
+			worker.join();
+	}
+	for (int i = 0; i < (int)todo.size(); ++i)
+		add(todo[i].first, todo[i].second, results[i]);
+}
+
+pair<int, int> PathStore::find(int src, int dest) const {
+	auto it = odPaths.find((int64_t)src * crossNum + dest);
+	if (it == odPaths.end())
+		return make_pair(0, -1);
+	return it->second;
+}
+
+pair<int, int> PathStore::add(int src, int dest, const vector<vector<int>>& paths) {
+	pair<int, int> range((int)pathStart.size() - 1, (int)paths.size());
+	for (const vector<int>& path : paths) {
+		nodes.insert(nodes.end(), path.begin(), path.end());
+		pathStart.emplace_back((int)nodes.size());
+	}
+	return odPaths[(int64_t)src * crossNum + dest] = range;
+}
+
+int PathStore::leastLoaded(const Graph& graph, int src, int dest, int blockRoadIdx) const {
+	pair<int, int> range = find(src, dest);
+	int best = -1;
+	double bestLoad = 0, bestTime = 0;
+	for (int i = range.first; i < range.first + range.second; ++i) {
+		if (nodes[pathStart[i]] / 2 == blockRoadIdx)
+			continue;
+		double load = 0, time = 0;
+		for (const int* p = begin(i); p != end(i); ++p) {
+			const Road& road = graph.roads[*p / 2];
+			int jam = *p % 2 == 0 ? road.forJam : road.backJam;
+			load = max(load, (double)jam / nodeCapacity[*p]);
+			time += freeTime[*p];
+		}
+		if (best == -1 or load < bestLoad or (load == bestLoad and time < bestTime)) {
+			best = i;
+			bestLoad = load;
+			bestTime = time;
+		}
+	}
+	return best;
+}
+
+size_t PathStore::bytes() const {
+	size_t total = (nodes.capacity() + pathStart.capacity() + nodeFrom.capacity() + nodeTo.capacity()
+		+ nodeCapacity.capacity()) * sizeof(int) + freeTime.capacity() * sizeof(double)
+		+ odPaths.size() * (sizeof(void*) + sizeof(pair<const int64_t, pair<int, int>>))
+		+ odPaths.bucket_count() * sizeof(void*);
+	for (const vector<Edge>& edges : adj)
+		total += edges.capacity() * sizeof(Edge);
+	return total;
+}
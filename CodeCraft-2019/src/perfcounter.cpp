@@ -0,0 +1,78 @@
+#include "perfcounter.h"
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+const char* PerfCounters::name(int event) {
+	static const char* names[PERF_EVENT_NUM] = {"cycles", "instructions", "LLC-misses", "branch-misses"};
+	return names[event];
+}
+
+#ifdef __linux__
+
+/*
+ * 各事件单独打开而不组成group，
+ * 虚拟机上常缺少LLC事件，单个失败不影响其余事件
+ */
+bool PerfCounters::open() {
+	static const uint64_t configs[PERF_EVENT_NUM] = {
+		PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+	};
+	close();
+	for (int i = 0; i < PERF_EVENT_NUM; ++i) {
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = configs[i];
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		fds[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+		if (fds[i] == -1)
+			cout << "perf_event_open " << name(i) << " failed: " << strerror(errno) << endl;
+	}
+	return enabled();
+}
+
+void PerfCounters::close() {
+	for (int i = 0; i < PERF_EVENT_NUM; ++i) {
+		if (fds[i] != -1)
+			::close(fds[i]);
+		fds[i] = -1;
+	}
+}
+
+void PerfCounters::read(uint64_t values[PERF_EVENT_NUM]) const {
+	for (int i = 0; i < PERF_EVENT_NUM; ++i) {
+		values[i] = 0;
+		if (fds[i] != -1 and ::read(fds[i], &values[i], sizeof(uint64_t)) != sizeof(uint64_t))
+			values[i] = 0;
+	}
+}
+
+#else
+
+bool PerfCounters::open() {
+	return false;
+}
+
+void PerfCounters::close() {}
+
+void PerfCounters::read(uint64_t values[PERF_EVENT_NUM]) const {
+	for (int i = 0; i < PERF_EVENT_NUM; ++i)
+		values[i] = 0;
+}
+
+#endif
+
+bool PerfCounters::enabled() const {
+	for (int i = 0; i < PERF_EVENT_NUM; ++i) {
+		if (fds[i] != -1)
+			return true;
+	}
+	return false;
+}
@@ -0,0 +1,64 @@
+#include "planner.h"
+#include "graph.h"
+#include "car.h"
+
+void RoutePlanner::init(const Graph& graph, const vector<pair<int, int>>& ods) {
+	store.init(graph);
+	if (yen) {
+		clock_t start = clock();
+		store.build(ods, k, threads);
+		cout << "Yen paths: " << store.pairs() << " od pairs, " << store.paths() << " paths, "
+			<< (clock() - start) * 1000 / CLOCKS_PER_SEC << " ms cpu" << endl;
+	}
+}
+
+pair<int, int> RoutePlanner::candidates(int src, int dest) {
+	pair<int, int> range = store.find(src, dest);
+	if (range.second != -1)
+		return range;
+	return store.add(src, dest, yen ? store.yenPaths(src, dest, k) : store.penaltyPaths(src, dest, k, diversity));
+}
+
+vector<int> RoutePlanner::roadIdxs(int path) const {
+	vector<int> route;
+	for (const int* p = store.begin(path); p != store.end(path); ++p)
+		route.emplace_back(*p / 2);
+	return route;
+}
+
+vector<int> RoutePlanner::choose(Graph& graph, const CarHot& car, int src, int dest, int blockRoadIdx) {
+	pair<int, int> range = candidates(src, dest);
+	int best = -1;
+	double bestCost = INF;
+	for (int i = range.first; i < range.first + range.second; ++i) {
+		if (*store.begin(i) / 2 == blockRoadIdx)
+			continue;
+		double cost = 0;
+		for (const int* p = store.begin(i); p != store.end(i); ++p)
+			cost += graph.getRoadWeight(graph.roads[*p / 2], car, *p % 2 == 0);
+		if (cost < bestCost) {
+			bestCost = cost;
+			best = i;
+		}
+	}
+	if (best == -1)
+		return vector<int>();
+	return roadIdxs(best);
+}
+
+vector<int> RoutePlanner::reroute(Graph& graph, const CarHot& car, int src, int dest, int blockRoadIdx) {
+	if (not yen)
+		return choose(graph, car, src, dest, blockRoadIdx);
+	candidates(src, dest);
+	int best = store.leastLoaded(graph, src, dest, blockRoadIdx);
+	if (best == -1)
+		return vector<int>();
+	return roadIdxs(best);
+}
+
+void RoutePlanner::report() const {
+	if (k == 0)
+		return;
+	cout << "Planner: " << store.pairs() << " od pairs, " << store.paths() << " paths, "
+		<< planned << " planned, " << revised << " revised" << endl;
+}
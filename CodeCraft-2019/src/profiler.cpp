@@ -0,0 +1,102 @@
+#include "profiler.h"
+
+#ifdef PROFILE
+
+static const char* phaseNames[PROF_PHASE_NUM] = {
+	"initWaitList", "driveJustCurrentRoad", "driveCarInitList", "driveCarInWaitState",
+	"updateRoadJam", "updateNextRoadSet", "saveFieldInfo", "recoverFieldInfo"
+};
+
+/*
+ * dead表示该时间片发生死锁，其结果直接作废
+ */
+void Profiler::endTick(int phase, int time, bool dead) {
+	TickProfile t;
+	t.phase = phase;
+	t.time = time;
+	t.rolledBack = dead;
+	for (int i = 0; i < PROF_PHASE_NUM; ++i) {
+		t.cycles[i] = cur[i];
+		cur[i] = 0;
+	}
+	ticks.emplace_back(t);
+	if (not dead)
+		live.emplace_back((int)ticks.size() - 1);
+}
+
+/*
+ * 恢复到time时刻的存档，time及之后的时间片作废
+ */
+void Profiler::rollback(int time) {
+	while (not live.empty() and ticks[live.back()].time >= time) {
+		ticks[live.back()].rolledBack = true;
+		live.pop_back();
+	}
+}
+
+void Profiler::report() const {
+	double nsPerCycle = chrono::duration<double, nano>(chrono::steady_clock::now() - startClock).count()
+		/ max<uint64_t>(1, now() - startTsc);
+	int n = (int)ticks.size();
+	int rolledBack = 0, dryRun = 0;
+	for (const TickProfile& t : ticks) {
+		rolledBack += t.rolledBack;
+		dryRun += t.phase == 0;
+	}
+	printf("Profile: %d ticks, %d rolled back, %d preset dry run\n", n, rolledBack, dryRun);
+	printf("%-22s %10s %7s %9s %9s %9s %9s %10s %9s\n", "phase", "total(ms)", "share",
+		"p50(us)", "p90(us)", "p99(us)", "max(us)", "wasted(ms)", "dry(ms)");
+
+	uint64_t all = 0, allWasted = 0, allDry = 0;
+	uint64_t totals[PROF_PHASE_NUM] = {};
+	for (const TickProfile& t : ticks) {
+		for (int i = 0; i < PROF_PHASE_NUM; ++i)
+			all += t.cycles[i];
+	}
+	vector<uint64_t> values(n);
+	for (int i = 0; i < PROF_PHASE_NUM; ++i) {
+		uint64_t wasted = 0, dry = 0;
+		for (int j = 0; j < n; ++j) {
+			values[j] = ticks[j].cycles[i];
+			totals[i] += values[j];
+			if (ticks[j].rolledBack)
+				wasted += values[j];
+			if (ticks[j].phase == 0)
+				dry += values[j];
+		}
+		allWasted += wasted;
+		allDry += dry;
+		sort(values.begin(), values.end());
+		auto pct = [&](double p)->double {
+			return n == 0 ? 0 : values[min(n - 1, (int)(p * n))] * nsPerCycle / 1e3;
+		};
+		printf("%-22s %10.1f %6.1f%% %9.1f %9.1f %9.1f %9.1f %10.1f %9.1f\n", phaseNames[i],
+			totals[i] * nsPerCycle / 1e6, 100.0 * totals[i] / max<uint64_t>(1, all),
+			pct(0.5), pct(0.9), pct(0.99), pct(1.0), wasted * nsPerCycle / 1e6, dry * nsPerCycle / 1e6);
+	}
+	printf("%-22s %10.1f  (%.1f%% in rolled back ticks, %.1f%% in preset dry run)\n", "total",
+		all * nsPerCycle / 1e6, 100.0 * allWasted / max<uint64_t>(1, all), 100.0 * allDry / max<uint64_t>(1, all));
+	if (counters.enabled())
+		reportCounters();
+}
+
+/*
+ * 各阶段硬件计数器总数，以及IPC、每千条指令的LLC缺失与分支预测失败
+ */
+void Profiler::reportCounters() const {
+	printf("%-22s", "phase");
+	for (int i = 0; i < PERF_EVENT_NUM; ++i)
+		printf(" %14s", PerfCounters::name(i));
+	printf(" %6s %9s %9s\n", "IPC", "LLC-MPKI", "br-MPKI");
+	for (int i = 0; i < PROF_PHASE_NUM; ++i) {
+		const uint64_t* e = events[i];
+		printf("%-22s", phaseNames[i]);
+		for (int j = 0; j < PERF_EVENT_NUM; ++j)
+			printf(" %14llu", (unsigned long long)e[j]);
+		double kiloInst = max<uint64_t>(1, e[PERF_INSTRUCTIONS]) / 1e3;
+		printf(" %6.2f %9.2f %9.2f\n", (double)e[PERF_INSTRUCTIONS] / max<uint64_t>(1, e[PERF_CYCLES]),
+			e[PERF_LLC_MISSES] / kiloInst, e[PERF_BRANCH_MISSES] / kiloInst);
+	}
+}
+
+#endif
@@ -0,0 +1,39 @@
+#include "rankcache.h"
+
+static const char rankCacheMagic[8] = {'C', 'C', '2', '0', '1', '9', 'P', 'R'};
+
+/*
+ * 文件不存在、格式不符或摘要不一致时返回false
+ */
+bool RankCache::load(const string& path, uint64_t inputHash, vector<int>& ids) {
+	ifstream in(path, ios::in | ios::binary);
+	if (in.fail())
+		return false;
+	RankCacheHeader header;
+	if (not in.read((char*)&header, sizeof(header)))
+		return false;
+	if (memcmp(header.magic, rankCacheMagic, sizeof(header.magic)) != 0 or header.version != version
+		or header.inputHash != inputHash or header.count < 0)
+		return false;
+	ids.resize(header.count);
+	if (not in.read((char*)ids.data(), header.count * sizeof(int))) {
+		ids.clear();
+		return false;
+	}
+	return true;
+}
+
+void RankCache::save(const string& path, uint64_t inputHash, const vector<int>& ids) {
+	RankCacheHeader header;
+	memcpy(header.magic, rankCacheMagic, sizeof(header.magic));
+	header.version = version;
+	header.count = (int)ids.size();
+	header.inputHash = inputHash;
+	ofstream out(path, ios::out | ios::binary);
+	if (out.fail()) {
+		cout << "fail to write " << path << endl;
+		return;
+	}
+	out.write((const char*)&header, sizeof(header));
+	out.write((const char*)ids.data(), ids.size() * sizeof(int));
+}
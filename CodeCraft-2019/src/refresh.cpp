@@ -0,0 +1,44 @@
+#include "refresh.h"
+#include "graph.h"
+
+/*
+ * 返回true时以当前道路状态作为新的基准
+ */
+bool RoutingRefresh::due(const vector<Road>& roads, bool force) {
+	bool rebuild = force or threshold <= 0 or base.size() != 3 * roads.size() or stale + 1 >= maxStale;
+	double drift = 0;
+	if (not rebuild) {
+		for (int i = 0; i < (int)roads.size(); ++i) {
+			const Road& road = roads[i];
+			double capacity = road.length * road.laneNumber;
+			drift += fabs((road.forJam + road.forPresetJam) / capacity - base[3 * i]);
+			drift += fabs((road.backJam + road.backPresetJam) / capacity - base[3 * i + 1]);
+			drift += fabs(road.penalty - base[3 * i + 2]);
+		}
+		rebuild = drift > threshold;
+	}
+	if (not rebuild) {
+		++stale;
+		++skipped;
+		maxDrift = max(maxDrift, drift);
+		return false;
+	}
+	base.resize(3 * roads.size());
+	for (int i = 0; i < (int)roads.size(); ++i) {
+		const Road& road = roads[i];
+		double capacity = road.length * road.laneNumber;
+		base[3 * i] = (road.forJam + road.forPresetJam) / capacity;
+		base[3 * i + 1] = (road.backJam + road.backPresetJam) / capacity;
+		base[3 * i + 2] = road.penalty;
+	}
+	stale = 0;
+	++rebuilds;
+	return true;
+}
+
+void RoutingRefresh::report() const {
+	if (threshold <= 0)
+		return;
+	cout << "Routing refresh: " << rebuilds << " rebuilds, " << skipped << " skipped ("
+		<< 100.0 * skipped / max(1, rebuilds + skipped) << "%), max skipped drift " << maxDrift << endl;
+}
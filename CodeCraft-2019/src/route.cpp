@@ -0,0 +1,38 @@
+#include "route.h"
+
+void RoutePool::grow(int idx) {
+	RouteSpan& span = spans[idx];
+	int newCap = max(8, span.cap * 2);
+	int newBegin = (int)data.size();
+	data.resize(data.size() + newCap);
+	copy(data.begin() + span.begin, data.begin() + span.begin + span.size, data.begin() + newBegin);
+	live += newCap - span.cap;
+	span.begin = newBegin;
+	span.cap = newCap;
+}
+
+void RoutePool::assign(int idx, const vector<int>& route) {
+	clear(idx);
+	if (spans[idx].cap < (int)route.size()) {
+		RouteSpan& span = spans[idx];
+		int newBegin = (int)data.size();
+		data.resize(data.size() + route.size());
+		live += (int)route.size() - span.cap;
+		span.begin = newBegin;
+		span.cap = (int)route.size();
+	}
+	copy(route.begin(), route.end(), data.begin() + spans[idx].begin);
+	spans[idx].size = (int)route.size();
+}
+
+void RoutePool::compact() {
+	vector<int> packed;
+	packed.reserve(live);
+	for (RouteSpan& span : spans) {
+		int newBegin = (int)packed.size();
+		packed.insert(packed.end(), data.begin() + span.begin, data.begin() + span.begin + span.size);
+		packed.resize(newBegin + span.cap);
+		span.begin = newBegin;
+	}
+	data.swap(packed);
+}
@@ -0,0 +1,133 @@
+#include "scenario.h"
+#include "scheduler.h"
+#include "parser.h"
+
+static const char scenarioMagic[8] = {'C', 'C', '2', '0', '1', '9', 'S', 'C'};
+
+void Scenario::save(Scheduler& s, const string& path) {
+	Graph& graph = s.graph;
+	vector<int> data;
+
+	for (Road& road : graph.roads) {
+		int record[7] = {road.id, road.length, road.speedLimit, road.laneNumber,
+			road.startId, road.endId, road.duplex ? 1 : 0};
+		data.insert(data.end(), record, record + 7);
+	}
+	for (Cross& cross : graph.crosses) {
+		int record[8] = {cross.id, cross.roads[0], cross.roads[1], cross.roads[2], cross.roads[3],
+			cross.x, cross.y, cross.edge ? 1 : 0};
+		data.insert(data.end(), record, record + 8);
+	}
+	for (int i = 0; i < (int)s.cars.size(); ++i) {
+		const Car& car = s.cars[i];
+		const CarHot& hot = Car::getHot(i);
+		int record[8] = {car.id, graph.crosses[car.src].id, graph.crosses[car.dest].id, hot.maxSpeed, car.planTime,
+			hot.prior ? 1 : 0, hot.preset ? 1 : 0, car.startTime};
+		data.insert(data.end(), record, record + 8);
+	}
+	int routeDataNum = 0;
+	for (int i = 0; i < (int)s.cars.size(); ++i) {
+		routeDataNum += Car::getRoute(i).size();
+		data.emplace_back(routeDataNum);
+	}
+	for (int i = 0; i < (int)s.cars.size(); ++i) {
+		for (int roadIdx : Car::getRoute(i))
+			data.emplace_back(graph.roads[roadIdx].id);
+	}
+
+	ScenarioHeader header;
+	memcpy(header.magic, scenarioMagic, sizeof(header.magic));
+	header.version = version;
+	header.roadNum = (int)graph.roads.size();
+	header.crossNum = (int)graph.crosses.size();
+	header.carNum = (int)s.cars.size();
+	header.routeDataNum = routeDataNum;
+	header.totalCapacity = graph.totalCapacity;
+
+	ofstream out(path, ios::out | ios::binary);
+	if (out.fail()) {
+		cout << "fail to write " << path << endl;
+		assert(false);
+	}
+	out.write((const char*)&header, sizeof(header));
+	out.write((const char*)data.data(), data.size() * sizeof(int));
+}
+
+void Scenario::load(Scheduler& s, const string& path) {
+	MappedFile file(path);
+	ScenarioHeader header;
+	if (file.size() < sizeof(header)) {
+		cout << "invalid scenario " << path << endl;
+		assert(false);
+		return;
+	}
+	memcpy(&header, file.begin(), sizeof(header));
+	if (memcmp(header.magic, scenarioMagic, sizeof(header.magic)) != 0 or header.version != version) {
+		cout << "invalid scenario " << path << endl;
+		assert(false);
+		return;
+	}
+	size_t expected = sizeof(header) + sizeof(int) * ((size_t)header.roadNum * 7 + header.crossNum * 8 +
+		header.carNum * 9 + header.routeDataNum);
+	if (file.size() != expected) {
+		cout << "invalid scenario " << path << endl;
+		assert(false);
+		return;
+	}
+
+	const int* p = (const int*)(file.begin() + sizeof(header));
+	Graph& graph = s.graph;
+	graph.totalCapacity = header.totalCapacity;
+
+	graph.roads.resize(header.roadNum);
+	for (Road& road : graph.roads) {
+		road.id = p[0];
+		road.length = p[1];
+		road.speedLimit = p[2];
+		road.laneNumber = p[3];
+		road.startId = p[4];
+		road.endId = p[5];
+		road.duplex = (p[6] == 1);
+		road.forJam = road.backJam = road.extraJam = 0;
+		road.forPresetJam = road.backPresetJam = 0;
+		road.penalty = 0;
+		road.keyRoad = false;
+		p += 7;
+	}
+	graph.crosses.resize(header.crossNum);
+	for (Cross& cross : graph.crosses) {
+		cross.id = p[0];
+		copy(p + 1, p + 5, cross.roads.begin());
+		cross.x = p[5];
+		cross.y = p[6];
+		cross.edge = (p[7] == 1);
+		cross.waitCarNum = 0;
+		cross.gapNum = 0;
+		p += 8;
+	}
+	graph.indexRoadsAndCrosses();
+	graph.linkCrosses();
+
+	s.cars.reserve(header.carNum);
+	Car::hots.clear();
+	Car::hots.reserve(header.carNum);
+	for (int i = 0; i < header.carNum; ++i) {
+		s.cars.emplace_back(p);
+		s.cars.back().src = graph.getCrossIdx(p[1]);
+		s.cars.back().dest = graph.getCrossIdx(p[2]);
+		Car::hots.emplace_back(Car::makeHot(p));
+		s.cars.back().startTime = p[7];
+		p += 8;
+	}
+	Car::initState(s.cars.size());
+
+	const int* routeEnds = p;
+	const int* routeData = p + header.carNum;
+	int routeBegin = 0;
+	for (int i = 0; i < header.carNum; ++i) {
+		RouteRef route = Car::getRoute(i);
+		for (int j = routeBegin; j < routeEnds[i]; ++j)
+			route.emplace_back(graph.getRoadIdx(routeData[j]));
+		routeBegin = routeEnds[i];
+	}
+}
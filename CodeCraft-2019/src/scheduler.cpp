@@ -1,10 +1,13 @@
 #include "scheduler.h"
 #include "graph.h"
 #include "car.h"
+#include "parser.h"
+#include "scenario.h"
+#include <array>
 
 int RoadSimulator::getForwardJamDegree() {
 	int sum = 0;
-	for (auto d: forward) {
+	for (const auto& d : forward) {
 		sum += d.size();
 	}
 	return sum;
@@ -12,17 +15,17 @@ int RoadSimulator::getForwardJamDegree() {
 
 int RoadSimulator::getBackwardJamDegree() {
 	int sum = 0;
-	for (auto d: backward) {
+	for (const auto& d : backward) {
 		sum += d.size();
 	}
 	return sum;
 }
 
-int RoadSimulator::getForwardPresetJamDegree(Scheduler* p) {
+int RoadSimulator::getForwardPresetJamDegree() {
 	int sum = 0;
-	for (auto d: forward) {
+	for (const auto& d : forward) {
 		for (int idx : d) {
-			if ((p->cars[idx]).prior){
+			if (Car::getPrior(idx)){
 				sum++;
 			}
 		}
@@ -30,11 +33,11 @@ int RoadSimulator::getForwardPresetJamDegree(Scheduler* p) {
 	return sum;
 }
 
-int RoadSimulator::getBackwardPresetJamDegree(Scheduler* p) {
+int RoadSimulator::getBackwardPresetJamDegree() {
 	int sum = 0;
-	for (auto d: backward) {
+	for (const auto& d : backward) {
 		for (int idx : d) {
-			if ((p->cars[idx]).prior){
+			if (Car::getPrior(idx)){
 				sum++;
 			}
 		}
@@ -44,10 +47,99 @@ int RoadSimulator::getBackwardPresetJamDegree(Scheduler* p) {
 
 
 
-Scheduler::Scheduler(ifstream& carStream, ifstream& roadStream, ifstream& crossStream, ifstream& presetAnswerStream):
-	graph(roadStream, crossStream) {
-	string line;
+Scheduler::Scheduler(const string& carPath, const string& roadPath, const string& crossPath, const string& presetAnswerPath):
+	graph(roadPath, crossPath) {
+	initParams();
+
+	/*
+	 * car与presetAnswer文件按行切分后并行解析，
+	 * 再按文件顺序合并
+	 */
+	MappedFile carFile(carPath);
+	typedef array<int, 7> CarRow;
+	auto carChunks = parseChunks<vector<CarRow>>(carFile, [](TupleReader& reader, vector<CarRow>& chunk) {
+		CarRow v;
+		while (reader.nextLine()) {
+			if (reader.nextInts(v.data(), 7))
+				chunk.emplace_back(v);
+		}
+	});
+	vector<CarRow> rows;
+	for (auto& chunk : carChunks)
+		rows.insert(rows.end(), chunk.begin(), chunk.end());
+
+	/*
+	 * 按(优先，计划出发时间，速度降序，id)排序后拆分为cars与hots两列
+	 */
+	auto lambda = [](const CarRow& c1, const CarRow& c2)->bool {
+		if (c1[5] != c2[5])
+			return c1[5] > c2[5];
+		if (c1[4] != c2[4])
+			return c1[4] < c2[4];
+		if (c1[3] != c2[3])
+			return c1[3] > c2[3];
+		return c1[0] < c2[0];
+	};
+	sort(rows.begin(), rows.end(), lambda);
+	cars.reserve(rows.size());
+	Car::hots.clear();
+	Car::hots.reserve(rows.size());
+	for (const CarRow& row : rows) {
+		cars.emplace_back(row.data());
+		cars.back().src = graph.getCrossIdx(row[1]);
+		cars.back().dest = graph.getCrossIdx(row[2]);
+		Car::hots.emplace_back(Car::makeHot(row.data()));
+	}
+	Car::initState(cars.size());
+	indexCars();
+
+	struct PresetChunk {
+		vector<int> ids;
+		vector<int> startTimes;
+		vector<int> routeEnds;	// 每条预置路径在roads中的结束位置
+		vector<int> roads;
+	};
+	MappedFile presetFile(presetAnswerPath);
+	auto presetChunks = parseChunks<PresetChunk>(presetFile, [](TupleReader& reader, PresetChunk& chunk) {
+		while (reader.nextLine()) {
+			int id, startTime, data;
+			if (not reader.nextInt(id) or not reader.nextInt(startTime))
+				continue;
+			chunk.ids.emplace_back(id);
+			chunk.startTimes.emplace_back(startTime);
+			while (reader.nextInt(data))
+				chunk.roads.emplace_back(data);
+			chunk.routeEnds.emplace_back((int)chunk.roads.size());
+		}
+	});
+	for (PresetChunk& chunk : presetChunks) {
+		int routeBegin = 0;
+		for (int i = 0; i < (int)chunk.ids.size(); ++i) {
+			int carIdx = getCarIdx(chunk.ids[i]);
+			cars[carIdx].startTime = chunk.startTimes[i];
+			RouteRef route = Car::getRoute(carIdx);
+			for (int j = routeBegin; j < chunk.routeEnds[i]; ++j)
+				route.emplace_back(graph.getRoadIdx(chunk.roads[j]));
+			routeBegin = chunk.routeEnds[i];
+		}
+	}
+	computeFactor();
+}
+
+/*
+ * 从预编译场景文件直接载入，
+ * 车辆已排序，路口坐标与边界已计算
+ */
+Scheduler::Scheduler(const string& scenarioPath) {
+	initParams();
+	Scenario::load(*this, scenarioPath);
+	indexCars();
+	computeFactor();
+}
+
+void Scheduler::initParams() {
 	goCarSize = upperBound*2/3;
+	nextVersion = 0;
 	stride = 50;
 	curTime = 0;
 	presetWay = priorWay = 0;
@@ -55,97 +147,80 @@ Scheduler::Scheduler(ifstream& carStream, ifstream& roadStream, ifstream& crossS
 	home = way = end = 0;
 	a = b = 0;
 	onlyPreset = false;
-	
-	while (getline(carStream, line)) {
-		if (line.empty() or line[0] == '#')
-			continue;
-		vector<int> temp(7);
-		sscanf(line.c_str(), "(%d, %d, %d, %d, %d, %d, %d)", &temp[0], &temp[1], &temp[2], &temp[3], &temp[4], &temp[5], &temp[6]);
-		cars.emplace_back(Car(temp));
-	}
-
-	Car::initState(cars.size());
+	answerWriter = nullptr;
+	committedInfo = 0;
+	traceStatus = traceLog = false;
+	replay = false;
+	deadCycle = false;
+}
 
-	auto lambda = [](const Car& c1, const Car& c2)->bool {
-		if (c1.prior and not c2.prior)
-			return true;
-		if (not c1.prior and c2.prior)
-			return false;
-		if (c1.planTime < c2.planTime)
-			return true;
-		if (c1.planTime > c2.planTime)
-			return false;
-		if (c1.maxSpeed > c2.maxSpeed)
-			return true;
-		if (c1.maxSpeed < c2.maxSpeed)
-			return false;
-		return c1.id < c2.id;
-	};
-	sort(cars.begin(), cars.end(), lambda);
+/*
+ * 建立车辆id到idx的映射以及车库队列，
+ * 要求cars已按优先级、计划时间、速度、id排序
+ */
+void Scheduler::indexCars() {
+	vector<int> ids(cars.size());
 	for (int i = 0; i < (int)cars.size(); ++i) {
-		carIdxes.emplace(cars[i].id, i);
-		if (cars[i].prior)
+		ids[i] = cars[i].id;
+		if (Car::getPrior(i))
 			priorCarIdxs.emplace_back(i);
 	}
-
-
+	carIdxes.build(ids);
 
 	garageCarList = vector<int>(cars.size(), 0);
 	for (int i = 0; i < (int)garageCarList.size(); i++) {
 		garageCarList[i] = i;
 	}
 	garageSize = (int)garageCarList.size();
-
-	while (getline(presetAnswerStream, line)) {
-		if (line.empty() or line[0] == '#')
-			continue;
-		for (char &ch : line) {
-			if (ch == '(' or ch == ')' or ch == ',')
-				ch = ' ';
-		}
-		stringstream ss;
-		int id, carIdx, startTime, data;
-
-		ss << line;
-		ss >> id >> startTime;
-		carIdx = getCarIdx(id);
-		cars[carIdx].startTime = startTime;
-		while (ss >> data)
-			cars[carIdx].route.emplace_back(data);
-	}
-	computeFactor();
 }
 
 int Scheduler::getCarIdx(int id) {
-	auto it = carIdxes.find(id);
-	assert(it != carIdxes.end());
-	return it->second;
+	return carIdxes[id];
 }
 
-void Scheduler::outputAnswer(ofstream& answerStream) {
-    answerStream << "#(carId,StartTime,RoadId...)" << endl;
-	for (Car &car : cars) {
-		if (car.preset and not car.reset)
-			continue;
-		answerStream << "(" << car.id << ", " << car.startTime;
-		for (int r : car.route)
-			answerStream << ", " << r;
-		answerStream << ")" << endl;
+/*
+ * streaming模式下只写出尚未确认的车辆，
+ * 否则一次性写出全部非预置车辆与被修改的预置车辆
+ */
+void Scheduler::outputAnswer(AnswerWriter& writer) {
+	if (writer.streaming) {
+		assert(answerWriter == &writer);
+		commitAnswer(INF);
+	} else {
+		writer.writeHeader();
+		for (int i = 0; i < (int)cars.size(); ++i) {
+			Car &car = cars[i];
+			if (Car::getPreset(i) and not Car::getReset(i))
+				continue;
+			writer.writeCar(car.id, car.startTime, Car::getRoute(i));
+		}
 	}
+	writer.flush();
+}
+
+/*
+ * 写出到达时间早于time的车辆
+ */
+void Scheduler::commitAnswer(int time) {
+	for (int carIdx : answerWriter->commit(time))
+		answerWriter->writeCar(cars[carIdx].id, cars[carIdx].startTime, Car::getRoute(carIdx));
 }
 
 void Scheduler::updateNextRoadSet() {
+	ScopedTimer timer(profiler, PROF_NEXT_ROAD);
 	auto pair = graph.floyd();
 	dist = pair.first;
 	next = pair.second;
+	++nextVersion;
 }
 
 void Scheduler::updateRoadJam() {
+	ScopedTimer timer(profiler, PROF_ROAD_JAM);
 	for (int i = 0; i < (int)network.size(); i++) {
 		graph.roads[i].forJam = network[i].getForwardJamDegree();
 		graph.roads[i].backJam = network[i].getBackwardJamDegree();
-		graph.roads[i].forPresetJam = network[i].getForwardPresetJamDegree(this);
-		graph.roads[i].backPresetJam = network[i].getBackwardPresetJamDegree(this);
+		graph.roads[i].forPresetJam = network[i].getForwardPresetJamDegree();
+		graph.roads[i].backPresetJam = network[i].getBackwardPresetJamDegree();
 	}
 }
 
@@ -162,12 +237,12 @@ void Scheduler::updateRoads(int targetTime) {
 
 int Scheduler::getRoadAfterNowRoadIdx(int carIdx) {
 	if (Car::getCarLocation(carIdx) == HOME) {
-		assert(not cars[carIdx].route.empty());
-		return cars[carIdx].route[0];
+		assert(not Car::getRoute(carIdx).empty());
+		return Car::getRoute(carIdx)[0];
 	}
-	if (Car::getNowRoadIdx(carIdx) == cars[carIdx].route.size() - 1)
+	if (Car::getNowRoadIdx(carIdx) == Car::getRoute(carIdx).size() - 1)
 		return DESTINATION;
-	return cars[carIdx].route[Car::getNowRoadIdx(carIdx) + 1];
+	return Car::getRoute(carIdx)[Car::getNowRoadIdx(carIdx) + 1];
 }
 
 bool Scheduler::decide(int carIdx) {
@@ -175,9 +250,9 @@ bool Scheduler::decide(int carIdx) {
 	assert(carIdx < (int)cars.size());
 
 	/*
-	 * 若为预置车辆，则搜索当前道路后一条道路。
+	 * 若为预置车辆或复现答案，则搜索当前道路后一条道路。
 	 */
-	if (cars[carIdx].preset and not cars[carIdx].reset) {
+	if (replay or (Car::getPreset(carIdx) and not Car::getReset(carIdx))) {
 		Car::getNextRoad(carIdx) = getRoadAfterNowRoadIdx(carIdx);
 		return true;
 	}
@@ -187,14 +262,17 @@ bool Scheduler::decide(int carIdx) {
 	 * 未做出决策则采用Dijkstra做出决策，
 	 * 否则搜索当前道路后一条道路。
 	 */
-	if (cars[carIdx].prior) {
-		if (cars[carIdx].route.empty())
-			cars[carIdx].route = graph.dijkstraForPrior(cars[carIdx]);
-		assert(not cars[carIdx].route.empty());
+	if (Car::getPrior(carIdx)) {
+		if (Car::getRoute(carIdx).empty())
+			Car::getRoute(carIdx) = graph.dijkstraForPrior(Car::getHot(carIdx), cars[carIdx].src, cars[carIdx].dest);
+		assert(not Car::getRoute(carIdx).empty());
 		Car::getNextRoad(carIdx) = getRoadAfterNowRoadIdx(carIdx);
 		return true;
 	}
 
+	if (planner.k > 0)
+		return decidePlanned(carIdx);
+
 	if (Car::getToCross(carIdx) == cars[carIdx].dest) {
 		Car::getNextRoad(carIdx) = DESTINATION;
 		return true;
@@ -203,49 +281,113 @@ bool Scheduler::decide(int carIdx) {
 	 * 若车辆进入上次决策道路失败，
 	 * 则仍返回上次决策道路。
 	 */
-	if (not cars[carIdx].route.empty() and
-		Car::getNowRoad(carIdx) != cars[carIdx].route.back()) {
-		Car::getNextRoad(carIdx) = cars[carIdx].route.back();
+	if (not Car::getRoute(carIdx).empty() and
+		Car::getNowRoad(carIdx) != Car::getRoute(carIdx).back()) {
+		Car::getNextRoad(carIdx) = Car::getRoute(carIdx).back();
 		return true;
 	}
 
 	if (Car::getCarLocation(carIdx) == HOME) {
-		int curCrossIdx = graph.getCrossIdx(cars[carIdx].src);
-		int nextCrossIdx = next[curCrossIdx][graph.getCrossIdx(cars[carIdx].dest)];
-		int nextRoadIdx = graph.getCrossRoadIdx(graph.crosses[curCrossIdx].id, graph.crosses[nextCrossIdx].id);
-		Car::getNextRoad(carIdx) = graph.roads[nextRoadIdx].id;
-		cars[carIdx].route.emplace_back(graph.roads[nextRoadIdx].id);
+		int curCrossIdx = cars[carIdx].src;
+		int nextCrossIdx = next[curCrossIdx][cars[carIdx].dest];
+		int nextRoadIdx = graph.getLinkRoadIdx(curCrossIdx, nextCrossIdx);
+		Car::getNextRoad(carIdx) = nextRoadIdx;
+		Car::getRoute(carIdx).emplace_back(nextRoadIdx);
 		return true;
 	}
 
 
-	int	curCrossIdx = graph.getCrossIdx(Car::getToCross(carIdx));
-	int nextCrossIdx = next[curCrossIdx][graph.getCrossIdx(cars[carIdx].dest)];
+	int	curCrossIdx = Car::getToCross(carIdx);
+	int nextCrossIdx = next[curCrossIdx][cars[carIdx].dest];
 	int nextRoadIdx = -1;
 	/*
 	 * 若最优路径下个路口为掉头路，
 	 * 在调度规则中不合法，
 	 * 则取当前路口中合法路径中最优解
 	 */
-	if (nextCrossIdx == graph.getCrossIdx(Car::getFromCross(carIdx))) {
-		int nextRoadId = graph.dijkstra(cars[carIdx], Car::getToCross(carIdx), cars[carIdx].dest, Car::getNowRoad(carIdx));
-		nextRoadIdx = graph.getRoadIdx(nextRoadId);
+	if (nextCrossIdx == Car::getFromCross(carIdx)) {
+		nextRoadIdx = graph.dijkstra(Car::getHot(carIdx), curCrossIdx, cars[carIdx].dest, Car::getNowRoad(carIdx));
 	} else {
-		nextRoadIdx = graph.getCrossRoadIdx(graph.crosses[curCrossIdx].id, graph.crosses[nextCrossIdx].id);
+		nextRoadIdx = graph.getLinkRoadIdx(curCrossIdx, nextCrossIdx);
 	}
-	if (Car::getCarLocation(carIdx) == HOME and graph.isRoadCongested(graph.roads[nextRoadIdx].id, curCrossIdx) and not cars[carIdx].reset) {
+	if (Car::getCarLocation(carIdx) == HOME and graph.isRoadCongested(nextRoadIdx, curCrossIdx) and not Car::getReset(carIdx)) {
 		return false;
 	}
-	Car::getNextRoad(carIdx) = graph.roads[nextRoadIdx].id;
+	Car::getNextRoad(carIdx) = nextRoadIdx;
 	assert(Car::getNextRoad(carIdx) != Car::getNowRoad(carIdx));
-	cars[carIdx].route.emplace_back(graph.roads[nextRoadIdx].id);
+	Car::getRoute(carIdx).emplace_back(nextRoadIdx);
+	return true;
+}
+
+/**
+ * 	整路径规划模式下非优先车辆的决策，
+ * 	出发时从候选路径中选出完整路径，之后沿路径行驶，
+ * 	只有下一道路拥堵时才从当前路口重新选择后续路径。
+ */
+bool Scheduler::decidePlanned(int carIdx) {
+	const Car& car = cars[carIdx];
+	const CarHot& hot = Car::getHot(carIdx);
+	RouteRef route = Car::getRoute(carIdx);
+	int destCrossIdx = car.dest;
+	if (Car::getCarLocation(carIdx) == HOME) {
+		int srcCrossIdx = car.src;
+		if (route.empty()) {
+			vector<int> planned = planner.choose(graph, hot, srcCrossIdx, destCrossIdx, -1);
+			assert(not planned.empty());
+
+			/*
+			 * 候选路径的第一条道路拥堵时，
+			 * 若next表给出的第一道路不拥堵，则改走该道路，再从其终点选择后续路径
+			 */
+			if (graph.isRoadCongested(planned[0], srcCrossIdx)) {
+				int nextCrossIdx = next[srcCrossIdx][destCrossIdx];
+				int firstRoadIdx = graph.getLinkRoadIdx(srcCrossIdx, nextCrossIdx);
+				if (not graph.isRoadCongested(firstRoadIdx, srcCrossIdx)) {
+					vector<int> rest = planner.choose(graph, hot, nextCrossIdx, destCrossIdx, firstRoadIdx);
+					if (not rest.empty() or nextCrossIdx == destCrossIdx) {
+						planned.swap(rest);
+						planned.insert(planned.begin(), firstRoadIdx);
+					}
+				}
+			}
+			route = planned;
+			++planner.planned;
+		}
+		Car::getNextRoad(carIdx) = route[0];
+		return true;
+	}
+
+	int pos = Car::getNowRoadIdx(carIdx);
+	if (pos == route.size() - 1) {
+		Car::getNextRoad(carIdx) = DESTINATION;
+		return true;
+	}
+	/*
+	 * 每个时间片都会重新决策，同一道路上只在第一次决策时修改路径，
+	 * 之后保持不变，与按答案复现时一致
+	 */
+	int curCrossIdx = Car::getToCross(carIdx);
+	int& decidedRoadIdx = Car::instantStates[carIdx].decidedRoadIdx;
+	if (decidedRoadIdx != pos and graph.isRoadCongested(route[pos + 1], curCrossIdx)) {
+		vector<int> rest = planner.reroute(graph, hot, curCrossIdx, destCrossIdx, Car::getNowRoad(carIdx));
+		if (not rest.empty() and rest[0] != route[pos + 1]) {
+			route.truncate(pos + 1);
+			for (int roadIdx : rest)
+				route.emplace_back(roadIdx);
+			++planner.revised;
+		}
+	}
+	decidedRoadIdx = pos;
+	Car::getNextRoad(carIdx) = route[pos + 1];
 	return true;
 }
 
 bool Scheduler::readyToGo(int carIdx) {
 	if (onlyPreset)
 		return false;
-	if (priorWay > 100 and not cars[carIdx].prior) {
+	if (departure.enabled)
+		return departure.admit(cars[carIdx].src, Car::getPrior(carIdx));
+	if (priorWay > 100 and not Car::getPrior(carIdx)) {
 		return (int)canGoCar.size() < goCarSize * 2 / 3 - priorWay;
 	}
 	return (int)canGoCar.size() < goCarSize;
@@ -258,16 +400,18 @@ void Scheduler::computeFactor() {
 	int maxSpeed = 0, minSpeed = 0x3f3f3f3f, priorMax = 0, priorMin = 0x3f3f3f3f;
 	int early = 0x3f3f3f3f, late = 0, priorEarly = 0x3f3f3f3f, priorLate = 0;
 	set<int> src, dest, priorSrc, priorDest;
-	for (Car& car: cars) {
-		maxSpeed = max(car.maxSpeed, maxSpeed);
-		minSpeed = min(car.maxSpeed, minSpeed);
+	for (int i = 0; i < (int)cars.size(); ++i) {
+		const Car& car = cars[i];
+		const CarHot& hot = Car::getHot(i);
+		maxSpeed = max(hot.maxSpeed, maxSpeed);
+		minSpeed = min(hot.maxSpeed, minSpeed);
 		early = min(car.planTime, early);
 		late = max(car.planTime, late);
 		src.emplace(car.src);
 		dest.emplace(car.dest);
-		if (car.prior) {
-			priorMax = max(car.maxSpeed, priorMax);
-			priorMin = min(car.maxSpeed, priorMin);
+		if (hot.prior) {
+			priorMax = max(hot.maxSpeed, priorMax);
+			priorMin = min(hot.maxSpeed, priorMin);
 			priorEarly = min(car.planTime, priorEarly);
 			priorLate = max(car.planTime, priorLate);
 			priorSrc.emplace(car.src);
@@ -1,10 +1,14 @@
 #include "scheduler.h"
 #include "graph.h"
 #include "car.h"
+#include "parser.h"
+#include "rankcache.h"
 
 vector<enum State> Car::states;
 vector<int> Car::nextRoads;
 vector<CarState> Car::instantStates;
+RoutePool Car::routes;
+vector<CarHot> Car::hots;
 
 void Scheduler::initNetwork() {
 	home = (int)cars.size();
@@ -25,9 +29,11 @@ void Scheduler::initNetwork() {
 }
 
 void Scheduler::saveFieldInfo() {
+	ScopedTimer timer(profiler, PROF_SAVE);
 	FieldInfo fieldInfo;
-	for (Car &car : cars)
-		fieldInfo.carRoutes.emplace_back(car.route);
+	if (Car::routes.fragmented())
+		Car::routes.compact();
+	fieldInfo.infoRoutes = Car::routes;
 
 	fieldInfo.infoInstantStates = Car::instantStates;
 	fieldInfo.infoNetwork = network;
@@ -47,11 +53,11 @@ void Scheduler::saveFieldInfo() {
 }
 
 void Scheduler::recoverFieldInfo(int k) {
+	ScopedTimer timer(profiler, PROF_RECOVER);
 	assert(not fieldInfoList.empty());
-	int i = max(0, (int)fieldInfoList.size() - k);
+	int i = max(committedInfo, (int)fieldInfoList.size() - k);
 	FieldInfo& fieldInfo = fieldInfoList[i];
-	for (int i = 0; i < (int)cars.size(); i++)
-		cars[i].route = fieldInfo.carRoutes[i];
+	Car::routes = fieldInfo.infoRoutes;
 
 	Car::instantStates.assign(fieldInfo.infoInstantStates.begin(), fieldInfo.infoInstantStates.end());
 	network.assign(fieldInfo.infoNetwork.begin(), fieldInfo.infoNetwork.end());
@@ -71,33 +77,106 @@ void Scheduler::recoverFieldInfo(int k) {
 		fieldInfoList.pop_back();
 }
 
-void Scheduler::changeTenPercent() {
-	initNetwork();
-	saveFieldInfo();
-	onlyPreset = true;
+/**
+ * 	只跑预置车辆直到全部到达，按到达时间从晚到早排序，优先车辆在前。
+ * 	预置车辆路径固定，按复现答案的方式推进，车库中只保留预置车辆，
+ * 	结束后恢复到开始前的存档。
+ */
+vector<int> Scheduler::rankPresetCars() {
 	vector<int> presetCars;
 	for (int i = 0; i < (int)cars.size(); ++i) {
-		if (cars[i].preset)
+		if (Car::getPreset(i))
 			presetCars.emplace_back(i);
 	}
-	while (end < presetCars.size()) {
+	/*
+	 * 保持完整车库排序后的相对顺序，只留下预置车辆
+	 */
+	if (not sorted and garageSize < 10000) {
+		sort(garageCarList.begin(), garageCarList.begin() + garageSize, [this](const int& idx1, const int& idx2)->bool { return Car::getMaxSpeed(idx1) < Car::getMaxSpeed(idx2); });
+		sorted = true;
+	}
+	int curJ = 0;
+	for (int j = 0; j < garageSize; ++j) {
+		if (Car::getPreset(garageCarList[j]))
+			garageCarList[curJ++] = garageCarList[j];
+	}
+	garageSize = curJ;
+	sorted = true;
+	replay = true;
+	while (end < (int)presetCars.size()) {
 		if (not run())
 			assert(false);
+		recordTick(0, 0, TICK_NORMAL);
+		profiler.endTick(0, curTime, false);
 		++curTime;
 		// 如果死锁，则说明只跑预制车导致死锁
 	}
+	replay = false;
 	auto lambda = [this](int idx1, int idx2)->bool {
-		if (this->cars[idx1].prior and not this->cars[idx2].prior)
+		if (Car::getPrior(idx1) and not Car::getPrior(idx2))
 			return true;
-		if (not this->cars[idx1].prior and this->cars[idx2].prior)
+		if (not Car::getPrior(idx1) and Car::getPrior(idx2))
 			return false;
 		return this->cars[idx1].reachTime > this->cars[idx2].reachTime;
 	};
 	sort(presetCars.begin(), presetCars.end(), lambda);
 	recoverFieldInfo(1);
+	for (int carIdx : presetCars)
+		cars[carIdx].reachTime = cars[carIdx].goTime = INF;
+	return presetCars;
+}
+
+/**
+ * 	将排序最靠前的10%预置车辆改为自行决策路径。
+ * 	排序只取决于输入，设置presetCachePath时按输入摘要缓存。
+ */
+void Scheduler::changeTenPercent() {
+	initNetwork();
+	saveFieldInfo();
+	onlyPreset = true;
+	vector<int> presetCars;
+	vector<int> ids;
+	uint64_t inputHash = presetCachePath.empty() ? 0 : inputDigest();
+	bool hit = not presetCachePath.empty() and RankCache::load(presetCachePath, inputHash, ids);
+	if (hit) {
+		/*
+		 * 缓存须恰好覆盖全部预置车辆且各出现一次，否则视为未命中
+		 */
+		int presetNum = 0;
+		for (int i = 0; i < (int)cars.size(); ++i) {
+			if (Car::getPreset(i))
+				++presetNum;
+		}
+		hit = (int)ids.size() == presetNum;
+		vector<char> seen(cars.size(), false);
+		for (int i = 0; hit and i < (int)ids.size(); ++i) {
+			int carIdx = carIdxes.find(ids[i]);
+			if (carIdx == -1 or not Car::getPreset(carIdx) or seen[carIdx])
+				hit = false;
+			else {
+				seen[carIdx] = true;
+				presetCars.emplace_back(carIdx);
+			}
+		}
+		if (hit)
+			cout << "preset ranking loaded from " << presetCachePath << endl;
+		else {
+			cout << "preset ranking cache " << presetCachePath << " does not match the preset cars, rebuilding" << endl;
+			presetCars.clear();
+			ids.clear();
+		}
+	}
+	if (not hit) {
+		presetCars = rankPresetCars();
+		if (not presetCachePath.empty()) {
+			for (int carIdx : presetCars)
+				ids.emplace_back(cars[carIdx].id);
+			RankCache::save(presetCachePath, inputHash, ids);
+		}
+	}
 	for (int i = 0; i < (int)presetCars.size()/10; ++i) {
-		cars[presetCars[i]].route.clear();
-		cars[presetCars[i]].reset = true;
+		Car::getRoute(presetCars[i]).clear();
+		Car::getReset(presetCars[i]) = true;
 	}
 	onlyPreset = false;
 	curTime = 0;
@@ -111,22 +190,66 @@ void Scheduler::simulate() {
 	int lastBlockTime = INF;
 	int step = 2;
 	curTime = 0;
+	if (lookahead.horizon > 0)
+		lookahead.init(*this);
+	if (departure.enabled)
+		departure.init(*this);
+	if (forecast.horizon > 0) {
+		forecast.init(*this);
+		graph.forecast = &forecast;
+	}
+	if (planner.k > 0) {
+		vector<pair<int, int>> ods;
+		for (int i = 0; i < (int)cars.size(); ++i) {
+			const CarHot& hot = Car::getHot(i);
+			if (not hot.prior and (not hot.preset or hot.reset))
+				ods.emplace_back(cars[i].src, cars[i].dest);
+		}
+		planner.init(graph, ods);
+	}
 
 	while (not taskfinished()) {
 		if (block) {
 			recoverFieldInfo(step);
+			profiler.rollback(curTime);
+			if (answerWriter != nullptr)
+				answerWriter->rollback(curTime);
 			goCarSize = max(min(upperBound / max(1, step-1), goCarSize - 1000), 2000);
 			stride = 4;
 		} else if (curTime % interval == 0) {
 			saveFieldInfo();
+			memory.sample(*this);
 			stride += 5;
+			if (answerWriter != nullptr) {
+				committedInfo = max(committedInfo, (int)fieldInfoList.size() - answerWriter->maxRollback);
+				commitAnswer(fieldInfoList[committedInfo].infoCurTime);
+			}
 		}
 		updateRoadJam();
-		updateNextRoadSet();
+		if (forecast.horizon > 0)
+			forecast.build(*this);
+		if (refresh.due(graph.roads, block))
+			updateNextRoadSet();
+
+		/*
+		 * 取回上一时间片启动的推演结果，
+		 * 预测即将死锁则提前收紧出发额度，
+		 * 再以当前路网启动下一次推演，与本时间片调度并行
+		 */
+		if (lookahead.horizon > 0) {
+			if (lookahead.collect() != -1 and not block)
+				goCarSize = max(goCarSize - lookahead.throttle, 2000);
+			lookahead.start(*this);
+		}
 
+		deadRoads.clear();
+		deadCrosses.clear();
 		if (not run()) {
-			cout << "-------------DEAD BLOCK: t = " << curTime << "---------------" << endl;
 			updatePenalty();
+			if (departure.enabled)
+				departure.onDeadBlock();
+			if (traceLog)
+				outputLog();
 			Car::freshState(cars.size());
 			if (lastBlockTime/interval == curTime/interval)
 				++step;
@@ -134,30 +257,44 @@ void Scheduler::simulate() {
 				step = 2;
 			lastBlockTime = curTime;
 			block = true;
-			for (int i = 0; i < (int)graph.roads.size(); i++) {
-				if (i % 20 == 0 and i != 0) {
-					cout << graph.roads[i].penalty << endl;
-				} else {
-					cout << graph.roads[i].penalty << "\t";
-				}
-			}
-			cout << endl;
+			recordTick(1, step, TICK_DEAD_BLOCK);
 		} else {
 			block = false;
 			goCarSize = min(upperBound, goCarSize + stride);
+			if (departure.enabled)
+				departure.onTick();
 			if (curTime > lastBlockTime) {
 				for (Road &road : graph.roads)
 					road.penalty = max(road.penalty - 0.01, 0.0);
 			}
 		}
+		if (not block) {
+			recordTick(1, step, TICK_NORMAL);
+			if (traceStatus)
+				outputStatus();
+		}
+		profiler.endTick(1, curTime, block);
 		++curTime;
-		cout << goCarSize << " " << step << endl;
 	}
+	lookahead.collect();
+
+	if (lookahead.horizon > 0)
+		cout << "Lookahead: " << lookahead.predicted << " predicted dead blocks" << endl;
+	refresh.report();
+	departure.report();
+	planner.report();
+	outputScore();
+}
 
+/**
+ * 按官方规则输出调度时间与总调度时间
+ */
+void Scheduler::outputScore() {
 	int sum = 0, priSum = 0, priReach = 0, priGo = 0x3f3f3f3f;
-	for (Car &car : cars) {
+	for (int i = 0; i < (int)cars.size(); ++i) {
+		const Car& car = cars[i];
 		sum += (car.reachTime - car.planTime);
-		if (car.prior) {
+		if (Car::getPrior(i)) {
 			priSum += (car.reachTime - car.planTime);
 			priReach = max(priReach, car.reachTime);
 			priGo = min(priGo, car.planTime);
@@ -173,6 +310,47 @@ void Scheduler::simulate() {
 	cout << "Total: " << (int)(b*priSum + sum) << endl;
 }
 
+/**
+ * 	judge按答案中固定的出发时间与路径复现调度，
+ * 	不做路径决策，也不更新道路权重，
+ * 	用于对已有答案重新评分。
+ * 	发生死锁返回false。
+ */
+bool Scheduler::judge() {
+	replay = true;
+	initNetwork();
+	curTime = 0;
+
+	/*
+	 * 所有车辆的出发时间都已过去后，
+	 * 连续stallLimit个时间片没有车辆出发或到达则判为调度失败
+	 */
+	const int stallLimit = 1000;
+	int lastStart = 0;
+	for (const Car& car : cars)
+		lastStart = max(lastStart, car.startTime);
+	int lastHome = home, lastEnd = end, lastProgress = 0;
+	while (not taskfinished()) {
+		if (not run()) {
+			cout << "dead block at t = " << curTime << endl;
+			return false;
+		}
+		if (home != lastHome or end != lastEnd) {
+			lastHome = home;
+			lastEnd = end;
+			lastProgress = curTime;
+		} else if (curTime > lastStart and curTime - lastProgress > stallLimit) {
+			cout << "no car departed or arrived since t = " << lastProgress << endl;
+			return false;
+		}
+		recordTick(1, 0, TICK_NORMAL);
+		profiler.endTick(1, curTime, false);
+		++curTime;
+	}
+	outputScore();
+	return true;
+}
+
 /**
  * 	taskfinished表示宏观上所有车辆是否到达目的地，
  */ 
@@ -210,14 +388,13 @@ bool Scheduler::run() {
 
 	driveCarInitList(false);
 
-	display();
-
 	Car::freshState(cars.size());
 
 	return true;
 }
 
 void Scheduler::driveJustCurrentRoad() {
+	ScopedTimer timer(profiler, PROF_DRIVE_CURRENT);
 	for (int i = 0; i < (int)network.size(); ++i) {
 		if (not graph.roads[i].duplex)
 			assert(network[i].backward.empty());
@@ -228,13 +405,25 @@ void Scheduler::driveJustCurrentRoad() {
 }
 
 bool Scheduler::driveCarInWaitState() {
+	ScopedTimer timer(profiler, PROF_WAIT_STATE);
 	int curWaiting = waiting, preWaiting;
+	// 未开启deadCycle时不建立等待图
+	if (deadCycle)
+		waitGraph.reset(2 * (int)graph.roads.size());
 	while (curWaiting > 0) {
-		for (Cross& cross : graph.crosses)
-			updateCrossCars(cross);
+		for (int crossIdx = 0; crossIdx < (int)graph.crosses.size(); ++crossIdx) {
+			updateCrossCars(crossIdx);
+			if (deadCycle and not waitGraph.cycle.empty()) {
+				reportDeadCycle();
+				return false;
+			}
+		}
 		preWaiting = waiting;
-		if (curWaiting == preWaiting)
+		if (curWaiting == preWaiting) {
+			if (deadCycle and not waitGraph.cycle.empty())
+				reportDeadCycle();
 			return false;
+		}
 		curWaiting = preWaiting;
 	}
 	return true;
@@ -255,7 +444,7 @@ void Scheduler::updateRoadCars(vector<deque<int>>& road, int roadIdx, int laneId
 		if (Car::getState(carIdx) == STOP)
 			continue;
 		if (i == 0) {
-			if (Car::getCarOffset(carIdx) + min(limitSpeed, cars[carIdx].maxSpeed) > graph.roads[roadIdx].length) {
+			if (Car::getCarOffset(carIdx) + min(limitSpeed, Car::getMaxSpeed(carIdx)) > graph.roads[roadIdx].length) {
 				if (Car::getState(carIdx) == READY)
 					++waiting;
 
@@ -267,16 +456,16 @@ void Scheduler::updateRoadCars(vector<deque<int>>& road, int roadIdx, int laneId
 				if (Car::getState(carIdx) == WAITING)
 					--waiting;
 				Car::getState(carIdx) = STOP;
-				Car::getCarOffset(carIdx) += min(limitSpeed, cars[carIdx].maxSpeed);
+				Car::getCarOffset(carIdx) += min(limitSpeed, Car::getMaxSpeed(carIdx));
 			}
 		} else {
 			int nextCarIdx = lane[i - 1];
-			if (Car::getCarOffset(carIdx) + min(limitSpeed, cars[carIdx].maxSpeed) < Car::getCarOffset(nextCarIdx)) {
+			if (Car::getCarOffset(carIdx) + min(limitSpeed, Car::getMaxSpeed(carIdx)) < Car::getCarOffset(nextCarIdx)) {
 				if (Car::getState(carIdx) == WAITING)
 					--waiting;
 
 				Car::getState(carIdx) = STOP;
-				Car::getCarOffset(carIdx) += min(limitSpeed, cars[carIdx].maxSpeed);
+				Car::getCarOffset(carIdx) += min(limitSpeed, Car::getMaxSpeed(carIdx));
 			} else {
 				if (Car::getState(nextCarIdx) == WAITING) {
 					if (Car::getState(carIdx) == READY)
@@ -302,36 +491,49 @@ void Scheduler::updateRoadCars(vector<deque<int>>& road, int roadIdx, int laneId
  * 由于可能存在依赖关系，
  * 因此循环调度路口所连接各道路
  */ 
-void Scheduler::updateCrossCars(Cross& cross) {
+void Scheduler::updateCrossCars(int crossIdx) {
+	const Cross& cross = graph.crosses[crossIdx];
 	struct Temp {
-		int roadId;
+		int roadIdx;
 		int idx;
 	};
-	assert(cross.roads.size() == 4);
-	vector<Temp> temp(cross.roads.size());
+	array<Temp, 4> temp;
 	for (int i = 0; i < (int)temp.size(); ++i) {
-		temp[i].roadId = cross.roads[i];
+		temp[i].roadIdx = cross.roadIdxs[i];
 		temp[i].idx = i;
 	}
-	sort(temp.begin(), temp.end(), [](const Temp& t1, const Temp& t2)->bool { return t1.roadId < t2.roadId; });
+	// 道路按id排序存放，按idx排序即按id排序
+	sort(temp.begin(), temp.end(), [](const Temp& t1, const Temp& t2)->bool { return t1.roadIdx < t2.roadIdx; });
 	for (auto &iter : temp) {
-		if (iter.roadId == -1)
+		if (iter.roadIdx == -1)
 			continue;
-		int roadIdx = graph.getRoadIdx(iter.roadId);
-		vector<deque<int>>* lanes = inOutLanes(roadIdx, cross.id, true);
+		int roadIdx = iter.roadIdx;
+		vector<deque<int>>* lanes = inOutLanes(roadIdx, crossIdx, true);
 		if (lanes == nullptr)
 			continue;
 		
 		int carIdx = -1;
+		int node = WaitForGraph::node(roadIdx, lanes == &network[roadIdx].forward);
 		while (getCarFromSequeue(*lanes, carIdx)) {
-			if (conflict(carIdx, iter.idx, cross))
+			int otherDir = conflictDir(carIdx, iter.idx, crossIdx);
+			if (otherDir != -1) {
+				int otherRoadIdx = cross.roadIdxs[otherDir];
+				if (deadCycle)
+					waitGraph.block(node, WaitForGraph::node(otherRoadIdx, graph.roads[otherRoadIdx].to == crossIdx));
 				break;
+			}
 			int oldLaneIdx = Car::getCarLaneIdx(carIdx);
-			if (moveToNextRoad(carIdx, roadIdx, cross.id, (*lanes)[oldLaneIdx])) {
+			if (moveToNextRoad(carIdx, roadIdx, crossIdx, (*lanes)[oldLaneIdx])) {
+				if (deadCycle)
+					waitGraph.progress(node);
 				updateRoadCars(*lanes, roadIdx, oldLaneIdx);
 				assert(lanes == &network[roadIdx].forward or lanes == &network[roadIdx].backward);
 				runCarInInitList(roadIdx, true, lanes == &network[roadIdx].forward);
 			} else {
+				if (deadCycle) {
+					int nextRoadIdx = Car::getNextRoad(carIdx);
+					waitGraph.block(node, WaitForGraph::node(nextRoadIdx, graph.roads[nextRoadIdx].from == crossIdx));
+				}
 				break;
 			}
 		}
@@ -341,12 +543,12 @@ void Scheduler::updateCrossCars(Cross& cross) {
 bool Scheduler::getCarFromSequeue(const vector<deque<int>>& lanes, int& carIdx) {
 	int offset = -1;
 	bool prior = false;
-	for (auto lane : lanes) {
+	for (const auto& lane : lanes) {
 		if (lane.empty() or Car::getState(lane[0]) != WAITING)
 			continue;
 		if (prior) {
 			// 当前检索到的第一优先级为优先车
-			if (not cars[lane[0]].prior)
+			if (not Car::getPrior(lane[0]))
 				continue;
 			if (Car::getCarOffset(lane[0]) > offset) {
 				carIdx = lane[0];
@@ -354,34 +556,42 @@ bool Scheduler::getCarFromSequeue(const vector<deque<int>>& lanes, int& carIdx)
 			}
 		} else {
 			// 当前检索到的第一优先级为非优先车
-			if (cars[lane[0]].prior or Car::getCarOffset(lane[0]) > offset) {
+			if (Car::getPrior(lane[0]) or Car::getCarOffset(lane[0]) > offset) {
 				carIdx = lane[0];
 				offset = Car::getCarOffset(carIdx);
-				prior = cars[carIdx].prior;
+				prior = Car::getPrior(carIdx);
 			}
 		}
 	}
 	return offset != -1;
 }
 
-bool Scheduler::conflict(int carIdx, int direction, const Cross& cross) {
-	if (conflict(carIdx, direction, (direction + 1)%4, cross))
-		return true;
-	if (conflict(carIdx, direction, (direction + 2)%4, cross))
-		return true;
-	return conflict(carIdx, direction, (direction + 3)%4, cross);
+bool Scheduler::conflict(int carIdx, int direction, int crossIdx) {
+	return conflictDir(carIdx, direction, crossIdx) != -1;
+}
+
+/**
+ * 返回与当前车辆冲突的道路方向，
+ * 无冲突返回-1
+ */
+int Scheduler::conflictDir(int carIdx, int direction, int crossIdx) {
+	for (int i = 1; i < 4; ++i) {
+		if (conflict(carIdx, direction, (direction + i)%4, crossIdx))
+			return (direction + i)%4;
+	}
+	return -1;
 }
 
-bool Scheduler::conflict(int carIdx, int direction, int otherDir, const Cross& cross) {
+bool Scheduler::conflict(int carIdx, int direction, int otherDir, int crossIdx) {
+	const Cross& cross = graph.crosses[crossIdx];
 	assert(direction != otherDir);
 	assert(Car::getNextRoad(carIdx) != NOT_DECIDED);
-	assert(Car::getNowRoad(carIdx) == cross.roads[direction]);
+	assert(Car::getNowRoad(carIdx) == cross.roadIdxs[direction]);
 
-	int roadId = cross.roads[otherDir];
-	if (roadId == -1)
+	int roadIdx = cross.roadIdxs[otherDir];
+	if (roadIdx == -1)
 		return false;
-	int roadIdx = graph.getRoadIdx(roadId);
-	vector<deque<int>>* lanes = inOutLanes(roadIdx, cross.id, true);
+	vector<deque<int>>* lanes = inOutLanes(roadIdx, crossIdx, true);
 	if (lanes == nullptr)
 		return false;
 	int firstCarIdx = -1;
@@ -389,33 +599,33 @@ bool Scheduler::conflict(int carIdx, int direction, int otherDir, const Cross& c
 		return false;
 	
 	assert(Car::getNextRoad(firstCarIdx) != NOT_DECIDED);
-	if (cars[carIdx].prior and (not cars[firstCarIdx].prior))
+	if (Car::getPrior(carIdx) and (not Car::getPrior(firstCarIdx)))
 		return false;
-	if ((not cars[carIdx].prior) and cars[firstCarIdx].prior) {
+	if ((not Car::getPrior(carIdx)) and Car::getPrior(firstCarIdx)) {
 		int nextRoad1, nextRoad2;
 		if (Car::getNextRoad(carIdx) == DESTINATION and Car::getNextRoad(firstCarIdx) == DESTINATION)
 			return false;
 		if (Car::getNextRoad(carIdx) == DESTINATION)
-			nextRoad1 = cross.roads[(direction + 2)%4];
+			nextRoad1 = cross.roadIdxs[(direction + 2)%4];
 		else 
 			nextRoad1 = Car::getNextRoad(carIdx);
 		
 		if (Car::getNextRoad(firstCarIdx) == DESTINATION)
-			nextRoad2 = cross.roads[(otherDir + 2)%4];
+			nextRoad2 = cross.roadIdxs[(otherDir + 2)%4];
 		else 
 			nextRoad2 = Car::getNextRoad(firstCarIdx);
 
 		return nextRoad1 == nextRoad2;
 	}
-	if (Car::getNextRoad(carIdx) == DESTINATION or Car::getNextRoad(carIdx) == cross.roads[(direction + 2)%4])
+	if (Car::getNextRoad(carIdx) == DESTINATION or Car::getNextRoad(carIdx) == cross.roadIdxs[(direction + 2)%4])
 		return false;
-	if (Car::getNextRoad(carIdx) == cross.roads[(direction + 1)%4]) {
+	if (Car::getNextRoad(carIdx) == cross.roadIdxs[(direction + 1)%4]) {
 		if (otherDir == ((direction + 3)%4))
 			return Car::getNextRoad(firstCarIdx) == DESTINATION or
 					Car::getNextRoad(firstCarIdx) == Car::getNextRoad(carIdx);
 		return false;
 	}
-	if (Car::getNextRoad(carIdx) == cross.roads[(direction + 3)%4]) {
+	if (Car::getNextRoad(carIdx) == cross.roadIdxs[(direction + 3)%4]) {
 		if (otherDir == ((direction + 1)%4))
 			return Car::getNextRoad(firstCarIdx) == DESTINATION or
 					Car::getNextRoad(firstCarIdx) == Car::getNextRoad(carIdx);
@@ -443,7 +653,7 @@ bool Scheduler::getChannel(const vector<deque<int>>& lanes, int& channel) {
 	return false;
 }
 
-bool Scheduler::moveToNextRoad(int carIdx, int nowRoadIdx, int crossId, deque<int>& nowLane) {
+bool Scheduler::moveToNextRoad(int carIdx, int nowRoadIdx, int crossIdx, deque<int>& nowLane) {
 	if (Car::getNextRoad(carIdx) == DESTINATION) {
 		assert(not nowLane.empty() and nowLane[0] == carIdx);
 		nowLane.pop_front();
@@ -452,20 +662,22 @@ bool Scheduler::moveToNextRoad(int carIdx, int nowRoadIdx, int crossId, deque<in
 		Car::getState(carIdx) = STOP;
 		Car::getCarLocation(carIdx) = END;
 		cars[carIdx].reachTime = curTime;
+		if (answerWriter != nullptr and (not Car::getPreset(carIdx) or Car::getReset(carIdx)))
+			answerWriter->onCarEnd(carIdx, curTime);
 		++end; --way;
-		if (cars[carIdx].preset)
+		if (Car::getPreset(carIdx))
 			presetWay--;
-		if (cars[carIdx].prior)
+		if (Car::getPrior(carIdx))
 			priorWay--;
 		canGoCar.erase(carIdx);
 		return true;
 	}
 	
-	int nextRoadIdx = graph.getRoadIdx(Car::getNextRoad(carIdx));
-	vector<deque<int>>* nextLanes = inOutLanes(nextRoadIdx, crossId, false);
+	int nextRoadIdx = Car::getNextRoad(carIdx);
+	vector<deque<int>>* nextLanes = inOutLanes(nextRoadIdx, crossIdx, false);
 	assert(nextLanes != nullptr);
 	int remain = graph.roads[nowRoadIdx].length - Car::getCarOffset(carIdx);
-	int nextRoadSpeed = min(graph.roads[nextRoadIdx].speedLimit, cars[carIdx].maxSpeed);
+	int nextRoadSpeed = min(graph.roads[nextRoadIdx].speedLimit, Car::getMaxSpeed(carIdx));
 	int channel = -1;
 	if (not getChannel(*nextLanes, channel) or remain >= nextRoadSpeed) {
 		Car::getCarOffset(carIdx) = graph.roads[nowRoadIdx].length;
@@ -498,9 +710,9 @@ bool Scheduler::moveToNextRoad(int carIdx, int nowRoadIdx, int crossId, deque<in
 	Car::getState(carIdx) = STOP;
 	Car::getCarLaneIdx(carIdx) = channel;
 	Car::getCarOffset(carIdx) = offset;
-	Car::getFromCross(carIdx) = crossId;
-	Car::getToCross(carIdx) = (graph.roads[nextRoadIdx].startId == crossId)? 
-						graph.roads[nextRoadIdx].endId : graph.roads[nextRoadIdx].startId;
+	Car::getFromCross(carIdx) = crossIdx;
+	Car::getToCross(carIdx) = (graph.roads[nextRoadIdx].from == crossIdx)? 
+						graph.roads[nextRoadIdx].to : graph.roads[nextRoadIdx].from;
 	Car::getNowRoad(carIdx) = Car::getNextRoad(carIdx);
 	++Car::getNowRoadIdx(carIdx);
 	Car::getNextRoad(carIdx) = NOT_DECIDED;
@@ -509,6 +721,7 @@ bool Scheduler::moveToNextRoad(int carIdx, int nowRoadIdx, int crossId, deque<in
 
 
 void Scheduler::driveCarInitList(bool prior) {
+	ScopedTimer timer(profiler, PROF_INIT_LIST);
 	for (int i = 0; i < (int)graph.roads.size(); ++i) {
 		runCarInInitList(i, prior, true);
 		runCarInInitList(i, prior, false);
@@ -522,7 +735,7 @@ void Scheduler::runCarInInitList(int roadIdx, bool prior, bool forward) {
 	else
 		waiting = &network[roadIdx].backWait;
 	for (int idx : *waiting) {
-		if ((not cars[idx].prior) and prior)
+		if ((not Car::getPrior(idx)) and prior)
 			break;
 		if (Car::getCarLocation(idx) != HOME)
 			continue;
@@ -530,16 +743,16 @@ void Scheduler::runCarInInitList(int roadIdx, bool prior, bool forward) {
 	}
 }
 
-vector<deque<int>>* Scheduler::inOutLanes(int roadIdx, int crossId, bool in) {
+vector<deque<int>>* Scheduler::inOutLanes(int roadIdx, int crossIdx, bool in) {
 	vector<deque<int>>* lanes = nullptr; 
-	if (graph.roads[roadIdx].startId == crossId) {
+	if (graph.roads[roadIdx].from == crossIdx) {
 		if (in) {
 			if (graph.roads[roadIdx].duplex)
 				lanes = &network[roadIdx].backward;
 		} else {
 			lanes = &network[roadIdx].forward;
 		}
-	} else if (graph.roads[roadIdx].endId == crossId) {
+	} else if (graph.roads[roadIdx].to == crossIdx) {
 		if (in) {
 			lanes = &network[roadIdx].forward;
 		} else {
@@ -548,7 +761,7 @@ vector<deque<int>>* Scheduler::inOutLanes(int roadIdx, int crossId, bool in) {
 		}
 	} else {
 		cout << graph.roads[roadIdx].startId << " " << graph.roads[roadIdx].endId
-			<< " " << crossId << endl;
+			<< " " << graph.crosses[crossIdx].id << endl;
 		assert(false);
 	}
 	return lanes;
@@ -558,14 +771,14 @@ vector<deque<int>>* Scheduler::inOutLanes(int roadIdx, int crossId, bool in) {
 bool Scheduler::runToRoad(int carIdx) {
 	assert(Car::getNextRoad(carIdx) != NOT_DECIDED and Car::getNextRoad(carIdx) != DESTINATION);
 
-	int newRoadIdx = graph.getRoadIdx(Car::getNextRoad(carIdx));
+	int newRoadIdx = Car::getNextRoad(carIdx);
 	vector<deque<int>>* nextLane = inOutLanes(newRoadIdx, cars[carIdx].src, false);
 	assert(nextLane != nullptr);
 	int newLaneIdx = -1;
 	if (not getChannel(*nextLane, newLaneIdx))
 		return false;
 	
-	int nextRoadSpeed = min(graph.roads[newRoadIdx].speedLimit, cars[carIdx].maxSpeed);
+	int nextRoadSpeed = min(graph.roads[newRoadIdx].speedLimit, Car::getMaxSpeed(carIdx));
 	if (not (*nextLane)[newLaneIdx].empty()) {
 		int preCarIdx = (*nextLane)[newLaneIdx].back();
 		if (Car::getCarOffset(preCarIdx) <= nextRoadSpeed and Car::getState(preCarIdx) == WAITING) {
@@ -580,9 +793,9 @@ bool Scheduler::runToRoad(int carIdx) {
 		offset = nextRoadSpeed;
 	}
 	++way; --home;
-	if (cars[carIdx].preset)
+	if (Car::getPreset(carIdx))
 		presetWay++;
-	if (cars[carIdx].prior)
+	if (Car::getPrior(carIdx))
 		priorWay++;
 	(*nextLane)[newLaneIdx].push_back(carIdx);
 
@@ -591,8 +804,8 @@ bool Scheduler::runToRoad(int carIdx) {
 	Car::getState(carIdx) = STOP;
 	Car::getCarLocation(carIdx) = ROAD;
 	Car::getFromCross(carIdx) = cars[carIdx].src;
-	Car::getToCross(carIdx) = (cars[carIdx].src == graph.roads[newRoadIdx].startId)?
-						graph.roads[newRoadIdx].endId : graph.roads[newRoadIdx].startId;
+	Car::getToCross(carIdx) = (cars[carIdx].src == graph.roads[newRoadIdx].from)?
+						graph.roads[newRoadIdx].to : graph.roads[newRoadIdx].from;
 	Car::getCarLaneIdx(carIdx) = newLaneIdx;
 	Car::getNowRoad(carIdx) = Car::getNextRoad(carIdx);
 	Car::getNowRoadIdx(carIdx) = 0;
@@ -602,26 +815,29 @@ bool Scheduler::runToRoad(int carIdx) {
 }
 
 void Scheduler::initWaitList() {
+	ScopedTimer timer(profiler, PROF_INIT_WAIT);
 	for (RoadSimulator &road : network) {
 		road.backWait.clear();
 		road.forWait.clear();
 	}
+	if (departure.enabled and not onlyPreset and not replay)
+		departure.begin(*this);
 
 	vector<int> availCarList;
 	int curJ = 0;
 	if (not sorted and garageSize < 10000) {
-		sort(garageCarList.begin(), garageCarList.begin() + garageSize, [this](const int& idx1, const int& idx2)->bool { return this->cars[idx1].maxSpeed < this->cars[idx2].maxSpeed; });
+		sort(garageCarList.begin(), garageCarList.begin() + garageSize, [this](const int& idx1, const int& idx2)->bool { return Car::getMaxSpeed(idx1) < Car::getMaxSpeed(idx2); });
 		sorted = true;
 	}
 	for (int j = 0; j < garageSize; j++) {
 //	for (int i = 0; i < (int)cars.size(); ++i) {
 		int i = garageCarList[j];
-		if (not cars[i].preset and Car::getCarLocation(i) == HOME /*cars[i].startTime == NOT_DECIDED*/ and
+		if (not replay and not Car::getPreset(i) and Car::getCarLocation(i) == HOME /*cars[i].startTime == NOT_DECIDED*/ and
 			curTime >= cars[i].planTime) {
 			if (readyToGo(i)) {
 				cars[i].startTime = curTime;
 			} else {
-				cars[i].route.clear();
+				Car::getRoute(i).clear();
 				cars[i].startTime = NOT_DECIDED;
 			}
 		}
@@ -630,8 +846,8 @@ void Scheduler::initWaitList() {
 				canGoCar.emplace(i);
 				availCarList.emplace_back(i);
 			} else {
-				assert(not cars[i].preset and not cars[i].reset);
-				cars[i].route.clear();
+				assert(not Car::getPreset(i) and not Car::getReset(i));
+				Car::getRoute(i).clear();
 				cars[i].startTime = NOT_DECIDED;
 			}
 		} 
@@ -642,10 +858,10 @@ void Scheduler::initWaitList() {
 	garageSize = curJ;
 	for (int carIdx : availCarList) {
 		assert (Car::getNextRoad(carIdx) != NOT_DECIDED);
-		int nextRoadIdx = graph.getRoadIdx(Car::getNextRoad(carIdx));
-		if (cars[carIdx].src == graph.roads[nextRoadIdx].startId) {
+		int nextRoadIdx = Car::getNextRoad(carIdx);
+		if (cars[carIdx].src == graph.roads[nextRoadIdx].from) {
 			network[nextRoadIdx].forWait.emplace_back(carIdx);
-		} else if (cars[carIdx].src == graph.roads[nextRoadIdx].endId) {
+		} else if (cars[carIdx].src == graph.roads[nextRoadIdx].to) {
 			network[nextRoadIdx].backWait.emplace_back(carIdx);
 		} else {
 			assert(false);
@@ -653,9 +869,9 @@ void Scheduler::initWaitList() {
 	}
 
 	auto lambda = [this](int idx1, int idx2)->bool {
-		if (this->cars[idx1].prior and not this->cars[idx2].prior)
+		if (Car::getPrior(idx1) and not Car::getPrior(idx2))
 			return true;
-		if (not this->cars[idx1].prior and this->cars[idx2].prior)
+		if (not Car::getPrior(idx1) and Car::getPrior(idx2))
 			return false;
 		if (this->cars[idx1].startTime < this->cars[idx2].startTime)
 			return true;
@@ -669,12 +885,21 @@ void Scheduler::initWaitList() {
 	}
 }
 
+/**
+ * 惩罚所有存在等待车辆的道路，
+ * 开启deadCycle且发现了死锁环时只惩罚环上道路中的等待车辆
+ */
 void Scheduler::updatePenalty() {
 	const double stride = 0.1;
 	vector<int> penalty(graph.roads.size(), 0);
+	vector<bool> target(graph.roads.size(), not deadCycle or deadRoads.empty());
+	for (int roadIdx : deadRoads)
+		target[roadIdx] = true;
 	for (int carIdx = 0; carIdx < (int)cars.size(); ++carIdx) {
 		if (Car::getState(carIdx) == WAITING) {
-			int roadIdx = graph.getRoadIdx(Car::getNowRoad(carIdx));
+			int roadIdx = Car::getNowRoad(carIdx);
+			if (not target[roadIdx])
+				continue;
 			graph.roads[roadIdx].penalty += stride;
 			++penalty[roadIdx];
 		}
@@ -688,6 +913,56 @@ void Scheduler::updatePenalty() {
 }
 
 
+/**
+ * 记录当前时间片统计，死锁时同时记录死锁环
+ */
+void Scheduler::recordTick(int phase, int step, int event) {
+	if (digest.enabled() and not digest.check(phase, curTime, stateDigest())) {
+		digest.close();
+		trace.close();
+		exit(1);
+	}
+	if (not telemetry.enabled())
+		return;
+	TickRecord r;
+	r.phase = phase;
+	r.time = curTime;
+	r.home = home;
+	r.way = way;
+	r.end = end;
+	r.priorWay = priorWay;
+	r.presetWay = presetWay;
+	r.waiting = waiting;
+	r.goCarSize = goCarSize;
+	r.step = step;
+	r.event = event;
+	r.cycleLength = (int)deadRoads.size();
+	telemetry.record(r);
+	if (event == TICK_DEAD_BLOCK) {
+		RollbackEvent e;
+		e.time = curTime;
+		e.step = step;
+		for (int i = 0; i < (int)deadRoads.size(); ++i) {
+			e.roads.emplace_back(graph.roads[deadRoads[i]].id);
+			e.crosses.emplace_back(graph.crosses[deadCrosses[i]].id);
+		}
+		telemetry.recordRollback(e);
+	}
+}
+
+/**
+ * 将waitGraph中发现的死锁环转换为道路与路口序号
+ */
+void Scheduler::reportDeadCycle() {
+	deadRoads.clear();
+	deadCrosses.clear();
+	for (int node : waitGraph.cycle) {
+		const Road& road = graph.roads[WaitForGraph::roadOf(node)];
+		deadRoads.emplace_back(WaitForGraph::roadOf(node));
+		deadCrosses.emplace_back(WaitForGraph::forwardOf(node) ? road.to : road.from);
+	}
+}
+
 void Scheduler::display() {
 	cout << "t = " << curTime << ": " << home << " cars at home, " << way << " cars on the road, " 
 		<< end << " cars have reached destination, " << priorWay << " prior cars and " << presetWay << " preset cars on the road."  << endl;
@@ -697,7 +972,8 @@ void Scheduler::displayWaitingCars() {
 	for (int i = 0; i < (int)cars.size(); ++i) {
 		Car &car = cars[i];
 		if (Car::getCarLocation(i) == ROAD and Car::getState(i) == WAITING) {
-			cout << car.id << " " << Car::getNowRoad(i) << " " << Car::getFromCross(i) << " " << Car::getToCross(i)
+			cout << car.id << " " << graph.roads[Car::getNowRoad(i)].id << " " << graph.crosses[Car::getFromCross(i)].id
+				<< " " << graph.crosses[Car::getToCross(i)].id
 				<< " " <<  Car::getCarLocation(i) << " " << Car::getCarOffset(i) << endl;
 		}
 	}
@@ -708,7 +984,7 @@ void Scheduler::displayCarById(int id) {
 		Car &car = cars[i];
 		if (car.id == id) {
 			cout << "id: " << car.id << " laneIdx: " << Car::getCarOffset(i)
-				<< " offset: " << Car::getCarOffset(i) << " maxSpeed: " << car.maxSpeed << " ";
+				<< " offset: " << Car::getCarOffset(i) << " maxSpeed: " << Car::getMaxSpeed(i) << " ";
 			switch (Car::getState(i)) {
 				case READY: cout << "READY "; break;
 				case WAITING: cout << "WAITING "; break;
@@ -721,9 +997,7 @@ void Scheduler::displayCarById(int id) {
 }
 
 void Scheduler::displayRoadById(int id) {
-	auto it = graph.roadIdx.find(id);
-	assert(it != graph.roadIdx.end());
-	int idx = it->second;
+	int idx = graph.roadIdx[id];
 	cout << "id: " << graph.roads[idx].id << " length: " << graph.roads[idx].length << " " 
 		<< " laneNumber: " << graph.roads[idx].laneNumber << " " << graph.roads[idx].duplex << endl;
 	cout << "forward: " << endl;
@@ -744,97 +1018,235 @@ void Scheduler::displayRoadById(int id) {
 }
 
 
-void Scheduler::readAnswer(ifstream& answerIn) {
-	string line;
-	while (getline(answerIn, line)) {
-		if (line.empty() or line[0] == '#')
+/**
+ * 读入答案文件并检查，不合法时输出原因并返回false：
+ * 	未知车辆或道路，车辆重复出现；
+ * 	修改的预置车辆超过预置车辆数的10%；
+ * 	车辆缺少出发时间与路径，出发时间早于计划时间；
+ * 	路径中相邻道路不相连、逆行单向道路，或未从起点出发到达终点
+ */
+bool Scheduler::readAnswer(const string& answerPath) {
+	MappedFile answerFile(answerPath);
+	TupleReader reader(answerFile);
+	vector<char> listed(cars.size(), false);
+	int presetNum = 0, resetNum = 0;
+	for (int i = 0; i < (int)cars.size(); ++i)
+		presetNum += Car::getPreset(i);
+	while (reader.nextLine()) {
+		int carId, startTime;
+		if (not reader.nextInt(carId) or not reader.nextInt(startTime))
 			continue;
 
-		for (char &ch : line) {
-			if (ch == '(' or ch == ')' or ch == ',')
-				ch = ' ';
+		/*
+		 * 答案中出现的预置车辆为被修改的预置车辆，
+		 * 以答案中的出发时间与路径为准
+		 */
+		int carIdx = carIdxes.find(carId);
+		if (carIdx == -1) {
+			cout << "unknown car " << carId << " in answer" << endl;
+			return false;
+		}
+		if (listed[carIdx]) {
+			cout << "car " << carId << " appears twice in answer" << endl;
+			return false;
+		}
+		listed[carIdx] = true;
+		if (Car::getPreset(carIdx)) {
+			Car::getReset(carIdx) = true;
+			++resetNum;
 		}
-
-		stringstream ss;
-		ss << line;
-		int carId, startTime;
-		ss >> carId >> startTime;
-		
-		int carIdx = getCarIdx(carId);
-		if (cars[carIdx].preset)
-			continue;
 
 		cars[carIdx].startTime = startTime;
+		RouteRef route = Car::getRoute(carIdx);
+		route.clear();
 		int roadId;
-		while (ss >> roadId) {
-			cars[carIdx].route.emplace_back(roadId);
+		while (reader.nextInt(roadId)) {
+			int roadIdx = graph.roadIdx.find(roadId);
+			if (roadIdx == -1) {
+				cout << "unknown road " << roadId << " in route of car " << carId << endl;
+				return false;
+			}
+			route.emplace_back(roadIdx);
+		}
+	}
+	if (resetNum > presetNum / 10) {
+		cout << resetNum << " preset cars changed in answer, at most " << presetNum / 10 << " allowed" << endl;
+		return false;
+	}
+	for (int i = 0; i < (int)cars.size(); ++i) {
+		if (cars[i].startTime == INF or Car::getRoute(i).empty()) {
+			cout << "car " << cars[i].id << " has no start time or route in answer" << endl;
+			return false;
+		}
+		if (cars[i].startTime < cars[i].planTime) {
+			cout << "car " << cars[i].id << " starts at " << cars[i].startTime
+				<< " before its plan time " << cars[i].planTime << endl;
+			return false;
+		}
+		int cur = cars[i].src;
+		for (int roadIdx : Car::getRoute(i)) {
+			const Road& road = graph.roads[roadIdx];
+			if (road.from == cur) {
+				cur = road.to;
+			} else if (road.duplex and road.to == cur) {
+				cur = road.from;
+			} else {
+				cout << "route of car " << cars[i].id << " cannot enter road " << road.id
+					<< " from cross " << graph.crosses[cur].id << endl;
+				return false;
+			}
+		}
+		if (cur != cars[i].dest) {
+			cout << "route of car " << cars[i].id << " ends at cross " << graph.crosses[cur].id
+				<< " instead of " << graph.crosses[cars[i].dest].id << endl;
+			return false;
 		}
 	}
+	return true;
 }
 
+/**
+ * 输出所有等待车辆，
+ * 记录交给trace后台线程格式化写出
+ */
 void Scheduler::outputLog() {
-	cout << "timeSlice=" << curTime << endl;
+	trace.push(LOG_TICK, curTime);
 	for (int i = 0; i < (int)graph.roads.size(); ++i) {
-		cout << "id: " << graph.roads[i].id << " from: " << graph.roads[i].startId << " to: " << graph.roads[i].endId
-			 << " laneNumber: " << graph.roads[i].laneNumber << " speed: " << graph.roads[i].speedLimit 
-			 << " length: " << graph.roads[i].length << endl;
-		cout << "forward: " << endl;
-		for (int j = 0; j < (int)network[i].forward.size(); ++j) {
-			cout << "lane " << j << ": " << endl;
-			for (int carIdx : network[i].forward[j]) {
-				if (Car::getState(carIdx) != WAITING)
-					continue;
-				cout << "id: " << cars[carIdx].id << " position: " << Car::getCarOffset(carIdx)
-					<< " speed: " << cars[carIdx].maxSpeed << " start time: " << cars[carIdx].startTime
-					<< " src: " << cars[carIdx].src << " dest: " << cars[carIdx].dest;
-				if (cars[carIdx].preset)
-					cout << " preset";
-				cout << endl;
-			} 
-		}
-		cout << "backward: " << endl;
-		for (int j = 0; j < (int)network[i].backward.size(); ++j) {
-			cout << "lane " << j << ": " << endl;
-			for (int carIdx : network[i].backward[j]) {
-				if (Car::getState(carIdx) != WAITING)
-					continue;
-				cout << "id: " << cars[carIdx].id << " position: " << Car::getCarOffset(carIdx)
-					<< " speed: " << cars[carIdx].maxSpeed << " start time: " << cars[carIdx].startTime
-					<< " src: " << cars[carIdx].src << " dest: " << cars[carIdx].dest;
-				if (cars[carIdx].preset)
-					cout << " preset";
-				cout << endl;
-			} 
-		}
-		cout << "--------------------------" << endl;
-	}
-	cout << "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx" << endl;
+		const Road& road = graph.roads[i];
+		trace.push(LOG_ROAD, road.id, road.startId, road.endId, road.laneNumber, road.speedLimit, road.length);
+		for (int dir = 0; dir < 2; ++dir) {
+			const vector<deque<int>>& lanes = dir == 0 ? network[i].forward : network[i].backward;
+			trace.push(LOG_DIRECTION, dir == 0);
+			for (int j = 0; j < (int)lanes.size(); ++j) {
+				trace.push(LOG_LANE, j);
+				for (int carIdx : lanes[j]) {
+					if (Car::getState(carIdx) != WAITING)
+						continue;
+					const Car& car = cars[carIdx];
+					trace.push(LOG_CAR, car.id, Car::getCarOffset(carIdx), Car::getMaxSpeed(carIdx), car.startTime,
+						graph.crosses[car.src].id, graph.crosses[car.dest].id, Car::getPreset(carIdx));
+				}
+			}
+		}
+		trace.push(LOG_ROAD_END);
+	}
+	trace.push(LOG_TICK_END);
 }
 
+/**
+ * 将每条车道上的车辆追加到road_log.txt，
+ * 记录交给trace后台线程格式化写出
+ */
 void Scheduler::outputStatus() {
 	if (curTime == 0)
 		return;
-	ofstream status;
-	status.open("road_log.txt", ios::out|ios::app);
-	if (status.fail()) {
-		cout << "open road_log.txt failed" << endl;
-		assert(false);
-	}
 	for (int i = 0; i < (int)network.size(); ++i) {
 		int length = graph.roads[i].length;
 		for (int j = 0; j < (int)network[i].forward.size(); ++j) {
-			status << graph.roads[i].id << "," << curTime << "," << j << ",";
+			trace.push(STATUS_LANE, graph.roads[i].id, curTime, j);
 			for (int carIdx : network[i].forward[j])
-				status << length - Car::getCarOffset(carIdx) << "," << cars[carIdx].id << ",";
-			status << endl;
+				trace.push(STATUS_CAR, length - Car::getCarOffset(carIdx), cars[carIdx].id);
+			trace.push(STATUS_LANE_END);
 		}
 		if (graph.roads[i].duplex) {
 			for (int j = 0; j < (int)network[i].backward.size(); ++j) {
-				status << graph.roads[i].id << "," << curTime << "," << j << ",";
+				trace.push(STATUS_LANE, graph.roads[i].id, curTime, j);
 				for (int carIdx : network[i].backward[j])
-					status << length - Car::getCarOffset(carIdx) << "," << cars[carIdx].id << ",";
-				status << endl;
+					trace.push(STATUS_CAR, length - Car::getCarOffset(carIdx), cars[carIdx].id);
+				trace.push(STATUS_LANE_END);
+			}
+		}
+	}
+}
+
+/**
+ * 	当前调度状态的摘要，包括车道内容、车辆状态与路径、
+ * 	车库、出发名单、计数以及道路惩罚。
+ * 	路径按内容累加，与RoutePool中的存放位置无关。
+ * 	道路与路口按id累加，哨兵值原样保留。
+ */
+uint64_t Scheduler::stateDigest() {
+	auto roadId = [this](int idx)->int {
+		return idx >= 0 and idx < (int)graph.roads.size() ? graph.roads[idx].id : idx;
+	};
+	auto crossId = [this](int idx)->int {
+		return idx >= 0 and idx < (int)graph.crosses.size() ? graph.crosses[idx].id : idx;
+	};
+	StateHasher h;
+	h.add((uint64_t)curTime);
+	h.add((uint64_t)home);
+	h.add((uint64_t)way);
+	h.add((uint64_t)end);
+	h.add((uint64_t)presetWay);
+	h.add((uint64_t)priorWay);
+	h.add((uint64_t)waiting);
+	h.add((uint64_t)goCarSize);
+	h.add((uint64_t)stride);
+	h.add((uint64_t)sorted);
+
+	h.add(garageCarList.data(), garageCarList.data() + garageSize);
+	h.add((uint64_t)canGoCar.size());
+	for (int carIdx : canGoCar)
+		h.add((uint64_t)carIdx);
+
+	for (int i = 0; i < (int)network.size(); ++i) {
+		RoadSimulator& road = network[i];
+		for (auto* lanes : {&road.forward, &road.backward}) {
+			h.add((uint64_t)lanes->size());
+			for (deque<int>& lane : *lanes) {
+				h.add((uint64_t)lane.size());
+				for (int carIdx : lane)
+					h.add((uint64_t)carIdx);
 			}
 		}
+		h.add(graph.roads[i].penalty);
+	}
+
+	for (int i = 0; i < (int)cars.size(); ++i) {
+		const CarState& st = Car::instantStates[i];
+		h.add((uint64_t)Car::states[i]);
+		h.add((uint64_t)(uint32_t)roadId(Car::nextRoads[i]));
+		h.add((uint64_t)(uint32_t)crossId(st.from));
+		h.add((uint64_t)(uint32_t)crossId(st.to));
+		h.add((uint64_t)(uint32_t)st.offset);
+		h.add((uint64_t)(uint32_t)st.laneIdx);
+		h.add((uint64_t)st.location);
+		h.add((uint64_t)(uint32_t)roadId(st.nowRoad));
+		h.add((uint64_t)(uint32_t)st.nowRoadIdx);
+		h.add((uint64_t)(uint32_t)st.waitFor);
+		h.add((uint64_t)Car::routes.size(i));
+		for (const int* p = Car::routes.begin(i); p != Car::routes.end(i); ++p)
+			h.add((uint64_t)(uint32_t)roadId(*p));
+		h.add((uint64_t)(uint32_t)cars[i].startTime);
+		h.add((uint64_t)(uint32_t)cars[i].reachTime);
+		h.add((uint64_t)(uint32_t)cars[i].goTime);
+		h.add((uint64_t)Car::getReset(i));
 	}
-}
\ No newline at end of file
+	return h.value();
+}
+
+/**
+ * 	输入摘要，包括道路、路口、车辆与预置路径，
+ * 	用于判断缓存是否仍然有效。
+ */
+uint64_t Scheduler::inputDigest() {
+	StateHasher h;
+	for (const Road& road : graph.roads) {
+		int v[7] = {road.id, road.length, road.speedLimit, road.laneNumber, road.startId, road.endId, road.duplex};
+		h.add(v, v + 7);
+	}
+	for (const Cross& cross : graph.crosses) {
+		h.add((uint64_t)cross.id);
+		h.add(cross.roads.data(), cross.roads.data() + cross.roads.size());
+	}
+	for (int i = 0; i < (int)cars.size(); ++i) {
+		const Car& car = cars[i];
+		const CarHot& hot = Car::getHot(i);
+		int v[8] = {car.id, graph.crosses[car.src].id, graph.crosses[car.dest].id, hot.maxSpeed, car.planTime, hot.prior, hot.preset, car.startTime};
+		h.add(v, v + 8);
+		h.add((uint64_t)Car::routes.size(i));
+		for (const int* p = Car::routes.begin(i); p != Car::routes.end(i); ++p)
+			h.add((uint64_t)(uint32_t)graph.roads[*p].id);
+	}
+	return h.value();
+}
@@ -0,0 +1,72 @@
+#include "telemetry.h"
+
+/*
+ * 以.bin结尾的路径导出为二进制，否则导出为CSV
+ */
+void Telemetry::dump(const string& path) const {
+	if (path.size() >= 4 and path.compare(path.size() - 4, 4, ".bin") == 0)
+		dumpBinary(path);
+	else
+		dumpCsv(path);
+}
+
+/*
+ * 时间片统计写入path，回滚事件写入path.rollback
+ */
+void Telemetry::dumpCsv(const string& path) const {
+	ofstream out(path, ios::out);
+	if (out.fail()) {
+		cout << "fail to write " << path << endl;
+		assert(false);
+		return;
+	}
+	string buffer = "phase,time,home,way,end,priorWay,presetWay,waiting,goCarSize,step,event,cycleLength\n";
+	char line[256];
+	for (size_t i = 0; i < count; ++i) {
+		const TickRecord& r = at(i);
+		snprintf(line, sizeof(line), "%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", r.phase, r.time,
+			r.home, r.way, r.end, r.priorWay, r.presetWay, r.waiting, r.goCarSize, r.step, r.event, r.cycleLength);
+		buffer += line;
+	}
+	out << buffer;
+
+	ofstream events(path + ".rollback", ios::out);
+	if (events.fail()) {
+		cout << "fail to write " << path << ".rollback" << endl;
+		assert(false);
+		return;
+	}
+	events << "time,step,cycle(cross->road)\n";
+	for (const RollbackEvent& e : rollbacks) {
+		events << e.time << "," << e.step << ",";
+		for (int i = 0; i < (int)e.roads.size(); ++i)
+			events << (i == 0 ? "" : " ") << e.crosses[i] << "->" << e.roads[i];
+		events << "\n";
+	}
+}
+
+/*
+ * 二进制格式：
+ * 		int tickCount, TickRecord[tickCount]
+ * 		int eventCount, 每个事件(time, step, n, 路口id[n], 道路id[n])
+ */
+void Telemetry::dumpBinary(const string& path) const {
+	ofstream out(path, ios::out | ios::binary);
+	if (out.fail()) {
+		cout << "fail to write " << path << endl;
+		assert(false);
+		return;
+	}
+	int n = (int)count;
+	out.write((const char*)&n, sizeof(n));
+	for (size_t i = 0; i < count; ++i)
+		out.write((const char*)&at(i), sizeof(TickRecord));
+	n = (int)rollbacks.size();
+	out.write((const char*)&n, sizeof(n));
+	for (const RollbackEvent& e : rollbacks) {
+		int header[3] = {e.time, e.step, (int)e.roads.size()};
+		out.write((const char*)header, sizeof(header));
+		out.write((const char*)e.crosses.data(), e.crosses.size() * sizeof(int));
+		out.write((const char*)e.roads.data(), e.roads.size() * sizeof(int));
+	}
+}
@@ -0,0 +1,75 @@
+#include "trace.h"
+
+void TraceWriter::close() {
+	if (not worker.joinable())
+		return;
+	stopping.store(true);
+	worker.join();
+	stopping.store(false);
+}
+
+void TraceWriter::loop() {
+	TraceRecord r;
+	while (true) {
+		if (queue.pop(r)) {
+			handle(r);
+			continue;
+		}
+		if (stopping.load() and queue.empty())
+			break;
+		this_thread::sleep_for(chrono::microseconds(100));
+	}
+	fflush(stdout);
+	if (statusFile != nullptr) {
+		fclose(statusFile);
+		statusFile = nullptr;
+	}
+}
+
+void TraceWriter::handle(const TraceRecord& r) {
+	const int* v = r.v;
+	switch (r.type) {
+		case STATUS_LANE:
+			if (statusFile == nullptr) {
+				statusFile = fopen("road_log.txt", "a");
+				if (statusFile == nullptr) {
+					cout << "open road_log.txt failed" << endl;
+					assert(false);
+					return;
+				}
+				setvbuf(statusFile, nullptr, _IOFBF, 1 << 20);
+			}
+			fprintf(statusFile, "%d,%d,%d,", v[0], v[1], v[2]);
+			break;
+		case STATUS_CAR:
+			fprintf(statusFile, "%d,%d,", v[0], v[1]);
+			break;
+		case STATUS_LANE_END:
+			fputc('\n', statusFile);
+			break;
+		case LOG_TICK:
+			printf("timeSlice=%d\n", v[0]);
+			break;
+		case LOG_ROAD:
+			printf("id: %d from: %d to: %d laneNumber: %d speed: %d length: %d\n", v[0], v[1], v[2], v[3], v[4], v[5]);
+			break;
+		case LOG_DIRECTION:
+			printf(v[0] ? "forward: \n" : "backward: \n");
+			break;
+		case LOG_LANE:
+			printf("lane %d: \n", v[0]);
+			break;
+		case LOG_CAR:
+			printf("id: %d position: %d speed: %d start time: %d src: %d dest: %d%s\n",
+				v[0], v[1], v[2], v[3], v[4], v[5], v[6] ? " preset" : "");
+			break;
+		case LOG_ROAD_END:
+			printf("--------------------------\n");
+			break;
+		case LOG_TICK_END:
+			printf("xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx\n");
+			break;
+		default:
+			assert(false);
+	}
+}
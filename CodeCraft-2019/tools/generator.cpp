@@ -0,0 +1,271 @@
+#include "common.h"
+#include <random>
+#include <queue>
+#include <functional>
+#include <sys/stat.h>
+
+/**
+ *  生成网格地图的car、road、cross、presetAnswer文件，用于规模测试。
+ *
+ *  路口按行优先编号，第0行在最北侧。
+ *  每个路口的道路按北、东、南、西顺时针排列，没有道路为-1，
+ *  与detectEdge()的假设一致。
+ *  先以双向道路连成随机生成树保证强连通，
+ *  其余相邻路口按density连通，按duplex决定双向或随机单向。
+ */
+struct GenOptions {
+	int rows = 11, cols = 11;
+	double density = 0.9;
+	int laneMin = 1, laneMax = 3;
+	int lengthMin = 10, lengthMax = 50;
+	int speedMin = 6, speedMax = 16;
+	double duplex = 0.8;
+	int cars = 60000;
+	int carSpeedMin = 4, carSpeedMax = 18;
+	double prior = 0.1;
+	double preset = 0.05;
+	string plan = "uniform";	// uniform 或 exp
+	int planMax = 1000;
+	unsigned int seed = 2019;
+	string out = ".";
+};
+
+struct GenRoad {
+	int id;
+	int length, speed, lanes;
+	int from, to;		// 路口序号
+	bool duplex;
+};
+
+static bool parseRange(const char* s, int& lo, int& hi) {
+	return sscanf(s, "%d-%d", &lo, &hi) == 2 or (sscanf(s, "%d", &lo) == 1 and (hi = lo, true));
+}
+
+static void usage() {
+	cout << "usage: CodeCraft-2019-gen [--rows=R] [--cols=C] [--density=D] [--lanes=A-B] [--length=A-B]\n"
+		<< "    [--speed=A-B] [--duplex=D] [--cars=N] [--car-speed=A-B] [--prior=P] [--preset=P]\n"
+		<< "    [--plan=uniform|exp] [--plan-max=T] [--seed=S] [--out=DIR]" << endl;
+}
+
+static bool parseArgs(int argc, char* argv[], GenOptions& opt) {
+	for (int i = 1; i < argc; ++i) {
+		const char* a = argv[i];
+		if (strncmp(a, "--rows=", 7) == 0) opt.rows = atoi(a + 7);
+		else if (strncmp(a, "--cols=", 7) == 0) opt.cols = atoi(a + 7);
+		else if (strncmp(a, "--density=", 10) == 0) opt.density = atof(a + 10);
+		else if (strncmp(a, "--lanes=", 8) == 0) parseRange(a + 8, opt.laneMin, opt.laneMax);
+		else if (strncmp(a, "--length=", 9) == 0) parseRange(a + 9, opt.lengthMin, opt.lengthMax);
+		else if (strncmp(a, "--speed=", 8) == 0) parseRange(a + 8, opt.speedMin, opt.speedMax);
+		else if (strncmp(a, "--duplex=", 9) == 0) opt.duplex = atof(a + 9);
+		else if (strncmp(a, "--cars=", 7) == 0) opt.cars = atoi(a + 7);
+		else if (strncmp(a, "--car-speed=", 12) == 0) parseRange(a + 12, opt.carSpeedMin, opt.carSpeedMax);
+		else if (strncmp(a, "--prior=", 8) == 0) opt.prior = atof(a + 8);
+		else if (strncmp(a, "--preset=", 9) == 0) opt.preset = atof(a + 9);
+		else if (strncmp(a, "--plan=", 7) == 0) opt.plan = a + 7;
+		else if (strncmp(a, "--plan-max=", 11) == 0) opt.planMax = atoi(a + 11);
+		else if (strncmp(a, "--seed=", 7) == 0) opt.seed = (unsigned int)strtoul(a + 7, nullptr, 10);
+		else if (strncmp(a, "--out=", 6) == 0) opt.out = a + 6;
+		else return false;
+	}
+	return opt.rows >= 2 and opt.cols >= 2 and opt.cars > 0 and opt.laneMin >= 1 and opt.laneMin <= opt.laneMax
+		and opt.lengthMin >= 1 and opt.lengthMin <= opt.lengthMax and opt.speedMin >= 1 and opt.speedMin <= opt.speedMax
+		and opt.carSpeedMin >= 1 and opt.carSpeedMin <= opt.carSpeedMax and opt.planMax >= 1
+		and (opt.plan == "uniform" or opt.plan == "exp");
+}
+
+class Generator {
+	GenOptions opt;
+	mt19937 rng;
+	int crossNum;
+	vector<GenRoad> roads;
+	vector<vector<int>> crossRoads;		// 每个路口北东南西四个方向的道路序号
+	vector<vector<pair<int, int>>> out;	// 每个路口可驶出的(道路序号, 下一路口)
+
+	int uniform(int lo, int hi) {
+		return uniform_int_distribution<int>(lo, hi)(rng);
+	}
+
+	bool chance(double p) {
+		return uniform_real_distribution<double>(0, 1)(rng) < p;
+	}
+
+	int crossAt(int r, int c) const {
+		return r * opt.cols + c;
+	}
+
+	void addRoad(int a, int b, int dirFromA, bool duplex) {
+		GenRoad road;
+		road.length = uniform(opt.lengthMin, opt.lengthMax);
+		road.speed = uniform(opt.speedMin, opt.speedMax);
+		road.lanes = uniform(opt.laneMin, opt.laneMax);
+		road.duplex = duplex;
+		road.from = a;
+		road.to = b;
+		if (not duplex and chance(0.5))
+			swap(road.from, road.to);
+		int idx = (int)roads.size();
+		road.id = 5000 + idx;
+		roads.emplace_back(road);
+		crossRoads[a][dirFromA] = idx;
+		crossRoads[b][(dirFromA + 2) % 4] = idx;
+		out[road.from].emplace_back(idx, road.to);
+		if (duplex)
+			out[road.to].emplace_back(idx, road.from);
+	}
+
+public:
+	explicit Generator(const GenOptions& o): opt(o), rng(o.seed) {
+		crossNum = opt.rows * opt.cols;
+		crossRoads.assign(crossNum, vector<int>(4, -1));
+		out.resize(crossNum);
+	}
+
+	void buildGrid() {
+		// 所有相邻路口对，dir为从第一个路口看第二个路口的方向(1东，2南)
+		struct Edge { int a, b, dir; };
+		vector<Edge> edges;
+		for (int r = 0; r < opt.rows; ++r) {
+			for (int c = 0; c < opt.cols; ++c) {
+				if (c + 1 < opt.cols)
+					edges.push_back({crossAt(r, c), crossAt(r, c + 1), 1});
+				if (r + 1 < opt.rows)
+					edges.push_back({crossAt(r, c), crossAt(r + 1, c), 2});
+			}
+		}
+		shuffle(edges.begin(), edges.end(), rng);
+
+		// 随机生成树(并查集)，树边均为双向
+		vector<int> parent(crossNum);
+		for (int i = 0; i < crossNum; ++i)
+			parent[i] = i;
+		function<int(int)> find = [&](int x)->int { return parent[x] == x ? x : parent[x] = find(parent[x]); };
+		vector<bool> inTree(edges.size(), false);
+		for (int i = 0; i < (int)edges.size(); ++i) {
+			int ra = find(edges[i].a), rb = find(edges[i].b);
+			if (ra != rb) {
+				parent[ra] = rb;
+				inTree[i] = true;
+			}
+		}
+		vector<pair<Edge, bool>> chosen;
+		for (int i = 0; i < (int)edges.size(); ++i) {
+			if (inTree[i])
+				chosen.emplace_back(edges[i], true);
+			else if (chance(opt.density))
+				chosen.emplace_back(edges[i], chance(opt.duplex));
+		}
+		// 道路id按行优先顺序分配，保证road.txt按id升序
+		sort(chosen.begin(), chosen.end(), [](const pair<Edge, bool>& e1, const pair<Edge, bool>& e2)->bool {
+			return e1.first.a != e2.first.a ? e1.first.a < e2.first.a : e1.first.dir < e2.first.dir;
+		});
+		for (auto& e : chosen)
+			addRoad(e.first.a, e.first.b, e.first.dir, e.second);
+	}
+
+	/*
+	 * 按跳数求最短路径，返回道路序号序列，不可达返回空
+	 */
+	vector<int> route(int src, int dest) {
+		vector<int> prevRoad(crossNum, -1), prevCross(crossNum, -1);
+		vector<bool> seen(crossNum, false);
+		queue<int> q;
+		q.push(src);
+		seen[src] = true;
+		while (not q.empty()) {
+			int cur = q.front();
+			q.pop();
+			if (cur == dest)
+				break;
+			for (auto& e : out[cur]) {
+				if (seen[e.second])
+					continue;
+				seen[e.second] = true;
+				prevRoad[e.second] = e.first;
+				prevCross[e.second] = cur;
+				q.push(e.second);
+			}
+		}
+		vector<int> path;
+		if (not seen[dest])
+			return path;
+		for (int cur = dest; cur != src; cur = prevCross[cur])
+			path.emplace_back(prevRoad[cur]);
+		reverse(path.begin(), path.end());
+		return path;
+	}
+
+	int planTime() {
+		if (opt.plan == "exp") {
+			double mean = opt.planMax / 4.0;
+			int t = 1 + (int)exponential_distribution<double>(1.0 / mean)(rng);
+			return min(t, opt.planMax);
+		}
+		return uniform(1, opt.planMax);
+	}
+
+	bool write() {
+		mkdir(opt.out.c_str(), 0755);
+		ofstream roadOut(opt.out + "/road.txt"), crossOut(opt.out + "/cross.txt"),
+			carOut(opt.out + "/car.txt"), presetOut(opt.out + "/presetAnswer.txt");
+		if (roadOut.fail() or crossOut.fail() or carOut.fail() or presetOut.fail()) {
+			cout << "fail to write " << opt.out << endl;
+			return false;
+		}
+
+		roadOut << "#(id,length,speed,channel,from,to,isDuplex)\n";
+		for (GenRoad& road : roads) {
+			roadOut << "(" << road.id << ", " << road.length << ", " << road.speed << ", " << road.lanes
+				<< ", " << road.from + 1 << ", " << road.to + 1 << ", " << (road.duplex ? 1 : 0) << ")\n";
+		}
+
+		crossOut << "#(id,roadId,roadId,roadId,roadId)\n";
+		for (int i = 0; i < crossNum; ++i) {
+			crossOut << "(" << i + 1;
+			for (int d = 0; d < 4; ++d)
+				crossOut << ", " << (crossRoads[i][d] == -1 ? -1 : roads[crossRoads[i][d]].id);
+			crossOut << ")\n";
+		}
+
+		carOut << "#(id,from,to,speed,planTime, priority, preset)\n";
+		presetOut << "#(carId,StartTime,RoadId...)\n";
+		int presetNum = 0;
+		for (int i = 0; i < opt.cars; ++i) {
+			int id = 10000 + i;
+			int src = uniform(0, crossNum - 1), dest = uniform(0, crossNum - 2);
+			if (dest >= src)
+				++dest;
+			int speed = uniform(opt.carSpeedMin, opt.carSpeedMax);
+			int plan = planTime();
+			bool prior = chance(opt.prior);
+			vector<int> path;
+			bool preset = chance(opt.preset);
+			if (preset) {
+				path = route(src, dest);
+				preset = not path.empty();
+			}
+			carOut << "(" << id << ", " << src + 1 << ", " << dest + 1 << ", " << speed << ", " << plan
+				<< ", " << (prior ? 1 : 0) << ", " << (preset ? 1 : 0) << ")\n";
+			if (preset) {
+				presetOut << "(" << id << ", " << plan + uniform(0, 10);
+				for (int roadIdx : path)
+					presetOut << ", " << roads[roadIdx].id;
+				presetOut << ")\n";
+				++presetNum;
+			}
+		}
+		cout << crossNum << " crosses, " << roads.size() << " roads, " << opt.cars << " cars, "
+			<< presetNum << " preset cars written to " << opt.out << endl;
+		return true;
+	}
+};
+
+int main(int argc, char* argv[]) {
+	GenOptions opt;
+	if (not parseArgs(argc, argv, opt)) {
+		usage();
+		return 1;
+	}
+	Generator generator(opt);
+	generator.buildGrid();
+	return generator.write() ? 0 : 1;
+}